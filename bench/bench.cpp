@@ -0,0 +1,288 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Benchmarks for maze generation, stepping and rendering.
+ *
+ * Results are written as CSV to stdout, one row per benchmark:
+ *   benchmark,parameters,iterations,seconds,ops_per_second
+ * Every benchmark is repeated, until it ran for at least --time seconds
+ * (default 0.25). All seeds are fixed, so runs are comparable.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "environment/maze.hpp"
+#include "environment/fixed_maze.hpp"
+#include "environment/maze_batch.hpp"
+#include "environment/runner.hpp"
+#include "environment/solver.hpp"
+#include "board/curses.hpp"
+
+double min_time = 0.25;
+volatile uint64_t sink; // keeps results from being optimized away
+
+/** @brief Run a benchmark and print its result
+ *
+ * @param const char* name - Name of benchmark
+ * @param std::string params - Parameters of this run
+ * @param double ops - Operations per call of f
+ * @param F f - Function to measure
+ */
+template <typename F> void measure(const char *name, std::string params,
+		double ops, F f) {
+	uint64_t n = 0, batch = 1, i;
+	double elapsed = 0;
+	std::chrono::steady_clock::time_point start;
+	f(); // warm up
+	while (elapsed < min_time) {
+		start = std::chrono::steady_clock::now();
+		for (i = 0; i < batch; i++) { f(); }
+		elapsed += std::chrono::duration<double>(
+				std::chrono::steady_clock::now() - start).count();
+		n += batch;
+		batch *= 2;
+	}
+	printf("%s,%s,%llu,%.6f,%.1f\n", name, params.c_str(),
+			static_cast<unsigned long long>(n), elapsed, n * ops / elapsed);
+	fflush(stdout);
+}
+
+std::string size(int w, int h) {
+	return std::to_string(w) + "x" + std::to_string(h);
+}
+
+void generation() {
+	const int sizes[] = {16, 64, 256, 1024};
+	const char methods[] = {'d', 'k', 'p'};
+	uint64_t seed = 1;
+	for (char m : methods) {
+		for (int s : sizes) {
+			measure("generate", std::string(1, m) + " " + size(s, s), 1,
+					[m, s, &seed]{
+				Maze maze(s, s, m, seed++);
+				sink = maze.state();
+			});
+		}
+	}
+}
+
+void stepping() {
+	const unsigned int N = 4096;
+	unsigned char actions[N];
+	unsigned int i;
+	Random rng(7);
+	Maze maze(64, 64, 'k', 3);
+	FixedMaze<64, 64> fixed('k', 3);
+	Environment *env = &maze;
+	for (i = 0; i < N; i++) { actions[i] = 1 << rng.below(4); }
+	measure("act", "k 64x64", N, [env, &actions]{
+		unsigned int i;
+		uint64_t s = 0;
+		for (i = 0; i < N; i++) { s += env->act(actions[i]); }
+		sink = s;
+	});
+	measure("act", "k 64x64 fixed", N, [&fixed, &actions]{
+		unsigned int i;
+		uint64_t s = 0;
+		for (i = 0; i < N; i++) { s += fixed.act(actions[i]); }
+		sink = s;
+	});
+	measure("valid_actions", "k 64x64", N, [env, &actions]{
+		unsigned int i;
+		uint64_t s = 0;
+		for (i = 0; i < N; i++) {
+			s += env->valid_actions();
+			env->act(actions[i]);
+		}
+		sink = s;
+	});
+	measure("reset", "k 64x64 reward", 1, [env]{
+		sink = env->reset(true);
+	});
+	measure("reset", "k 64x64", 1, [env]{
+		sink = env->reset(false);
+	});
+}
+
+void branching() {
+	Maze maze(1024, 1024, 'k', 19);
+	MazeState saved = maze.snapshot();
+	unsigned char a = 0x01;
+	measure("snapshot", "k 1024x1024 act restore", 1, [&maze, &saved, &a]{
+		// branch off one step and go back
+		a = a == 0x08 ? 0x01 : a << 1;
+		maze.act(a);
+		maze.restore(saved);
+		sink = maze.state();
+	});
+	measure("clone", "k 1024x1024", 1, [&maze]{
+		Maze copy(maze);
+		sink = copy.act(0x02);
+	});
+}
+
+void batches() {
+	const unsigned int N = 1024;
+	std::vector<uint8_t> actions(N), done(N);
+	std::vector<uint32_t> states(N);
+	std::vector<float> rewards(N);
+	unsigned int i;
+	Random rng(11);
+	MazeBatch batch(N, 16, 16, 'k', 5);
+	for (i = 0; i < N; i++) { actions[i] = 1 << rng.below(4); }
+	measure("batch_step", "k 16x16 1024", N, [&]{
+		batch.step(actions.data(), states.data(), rewards.data(), done.data());
+		sink = states[0];
+	});
+}
+
+void runners() {
+	const unsigned int threads[] = {1, 2, 4, 8, 16, 32, 64};
+	const unsigned int shards = 64, per_shard = 256, N = shards * per_shard;
+	std::vector<uint8_t> actions(N), done(N);
+	std::vector<uint32_t> states(N);
+	std::vector<float> rewards(N);
+	unsigned int i;
+	Random rng(23);
+	for (i = 0; i < N; i++) { actions[i] = 1 << rng.below(4); }
+	for (unsigned int t : threads) {
+		Runner runner(shards, per_shard, 16, 16, 'k', 5, t, false);
+		measure("runner", "k 16x16 " + std::to_string(shards) + "x" +
+				std::to_string(per_shard) + " threads " + std::to_string(t), N,
+				[&]{
+			runner.step(actions.data(), states.data(), rewards.data(),
+					done.data(), nullptr);
+			sink = states[0];
+		});
+	}
+}
+
+/** @brief Plain queue based search, that stops at the target
+ *
+ * @param Environment& env - Map to search
+ * @param uint32_t source - Node to start at
+ * @param uint32_t target - Node to reach
+ * @param std::vector<uint32_t>& dist - Scratch space for distances
+ * @param std::vector<uint32_t>& order - Scratch space for the queue
+ *
+ * @return uint32_t number of steps, or UINT32_MAX if unreachable
+ */
+uint32_t queue_search(Environment &env, uint32_t source, uint32_t target,
+		std::vector<uint32_t> &dist, std::vector<uint32_t> &order) {
+	uint32_t h = env.height(), head = 0, n = 1, cell;
+	const int32_t moves[4] = {-1, static_cast<int32_t>(h), 1,
+		-static_cast<int32_t>(h)};
+	char open;
+	int d;
+	dist.assign(env.width() * h, UINT32_MAX);
+	order.resize(dist.size());
+	order[0] = source;
+	dist[source] = 0;
+	while (head < n && dist[target] == UINT32_MAX) {
+		cell = order[head++];
+		open = env.node(cell);
+		for (d = 0; d < 4; d++) {
+			if ((open & (1 << d)) && dist[cell + moves[d]] == UINT32_MAX) {
+				dist[cell + moves[d]] = dist[cell] + 1;
+				order[n++] = cell + moves[d];
+			}
+		}
+	}
+	return dist[target];
+}
+
+void solving() {
+	const int sizes[] = {64, 256, 1024};
+	const char methods[] = {'d', 'k'};
+	for (char m : methods) {
+		for (int s : sizes) {
+			Maze maze(s, s, m, 13);
+			Solver solver;
+			std::vector<uint32_t> dist, order;
+			std::string params = std::string(1, m) + " " + size(s, s);
+			solver.load(maze);
+			measure("solve", params, 1, [&solver, s]{
+				sink = solver.solve(0, s * s - 1, nullptr);
+			});
+			measure("queue_search", params, 1, [&, s]{
+				sink = queue_search(maze, 0, s * s - 1, dist, order);
+			});
+		}
+	}
+}
+
+void rendering() {
+	FILE *out = fopen("/dev/null", "w"), *in = fopen("/dev/null", "r");
+	if (out == nullptr || in == nullptr) {
+		fprintf(stderr, "Can't open /dev/null, skipping rendering\n");
+		return;
+	}
+	{
+		Maze maze(38, 9, 'k', 17);
+		std::vector<char> nodes = maze.nodes();
+		CursesBoard board("xterm-256color", out, in);
+		unsigned int t = 0;
+		board.setup();
+		board.setup(38, 9, nodes);
+		board.energy = 20; board.time_drain = 1; board.step_drain = 1;
+		board.seconds = 0; board.steps = 0; board.score = 0;
+		board.rx = 0; board.ry = 0;
+		measure("draw_board", "38x9 move", 1, [&board, &t]{
+			// walk back and forth along the top row
+			t++;
+			board.px = t % 38;
+			board.py = 0;
+			board.steps = t;
+			board.update();
+		});
+		measure("draw_board", "38x9 full", 1, [&board, &nodes]{
+			board.setup(38, 9, nodes);
+			board.update();
+		});
+	}
+	fclose(out);
+	fclose(in);
+}
+
+int main(int argc, char *argv[]) {
+	int i;
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--time") == 0 && i + 1 < argc) {
+			min_time = atof(argv[++i]);
+		}
+		else {
+			fprintf(stderr, "Usage: %s [--time SECONDS]\n", argv[0]);
+			return 1;
+		}
+	}
+	printf("benchmark,parameters,iterations,seconds,ops_per_second\n");
+	generation();
+	stepping();
+	branching();
+	batches();
+	runners();
+	solving();
+	rendering();
+	return 0;
+}
@@ -100,7 +100,7 @@ class Board {
 		std::string error_message;
 		/* Variables to be set for display */
 		char synth_help = ' ';
-		unsigned char px, py, rx, ry;
+		unsigned int px, py, rx, ry;
 		unsigned short  score;
 		unsigned int seconds, steps;
 		int energy, time_drain, step_drain;
@@ -34,11 +34,22 @@
  * @brief Curses bases user interface.
  *
  * This class covers the curses based User Interface.
+ *
+ * Mazes are rendered into a pad once. Mazes, that don't fit into the terminal,
+ * are shown through a viewport, which scrolls along with the player.
  */
 class CursesBoard : public Board {
 	public:
 		/** @brief Curses initializer, that calls initscr() internally. */
 		CursesBoard();
+		/** @brief Curses initializer for any terminal, that calls newterm()
+		 * internally
+		 *
+		 * @param const char* type - Terminal type (like xterm-256color)
+		 * @param FILE* out - Output of terminal
+		 * @param FILE* in - Input of terminal
+		 */
+		CursesBoard(const char *type, FILE *out, FILE *in);
 		/** @brief Desconstructor, that calls endwin() internally */
 		~CursesBoard();
 		/** @see Board for more information on any method */
@@ -60,10 +71,42 @@ class CursesBoard : public Board {
 	private:
 		/** @brief Method to handle statistics drawing */
 		void draw_stats();
-		/** @brief Method to handle game field drawing */
+		/** @brief Method to handle game field drawing
+		 *
+		 * Only tiles of player and reward are redrawn, once the maze is on
+		 * screen.
+		 */
 		void draw_board();
-		WINDOW *board_win;
-		WINDOW *stats_win;
+		/** @brief Draw walls and floors of the whole maze, once per setup */
+		void draw_maze();
+		/** @brief Move viewport, so it follows the player */
+		void follow();
+		/** @brief Draw a bar of half blocks, cleared up to its full length
+		 *
+		 * @param int y - Row inside of stats window
+		 * @param int x - Column inside of stats window
+		 * @param int value - Number of half blocks
+		 * @param int cells - Full length of bar
+		 */
+		void draw_bar(int y, int x, int value, int cells);
+		/** @brief Screen, if not initialized by initscr() */
+		SCREEN *screen = nullptr;
+		WINDOW *board_win = nullptr;
+		WINDOW *stats_win = nullptr;
+		/** @brief Pre-rendered maze, shown through board_win's viewport */
+		WINDOW *pad = nullptr;
+		/** @brief Viewport size and its upper left corner inside of pad */
+		int view_w, view_h, view_x, view_y;
+		/** @brief true, if everything has to be redrawn on next update */
+		bool fresh = true;
+		/** @brief Values currently on screen */
+		struct {
+			unsigned int px, py, rx, ry;
+			unsigned short score;
+			unsigned int seconds, steps;
+			int energy, time_drain, step_drain;
+			char synth_help;
+		} shown;
 };
 
 #endif // CURSESBOARD_H
@@ -0,0 +1,69 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <vector>
+
+#include "board.hpp"
+
+#ifndef NULLBOARD_H
+#define NULLBOARD_H
+
+/** @class NullBoard
+ *
+ * @brief User interface, that shows nothing.
+ *
+ * Every output method does nothing, so games can run without a terminal, for
+ * benchmarks or on servers. Input is taken from a script instead of a
+ * keyboard.
+ *
+ * @author Maxine Michalski
+ */
+class NullBoard : public Board {
+	public:
+		/** @brief initializer method
+		 *
+		 * @param std::string keys - Input to return from get_input(), one
+		 * character per call (u, r, d, l, q or e). Once all keys are used up,
+		 * 'q' is returned.
+		 */
+		NullBoard(std::string keys) : keys(keys) {};
+		/** @see Board for more information on any method */
+		bool capable() { return true; };
+		void setup() {};
+		void setup(unsigned int w, unsigned int h, std::vector<char> m);
+		void update() {};
+		void menu(std::vector<const char*> items, unsigned char active) {
+			(void)items; (void)active;
+		};
+		void menu(std::vector<const char*> items, unsigned char active,
+				std::vector<unsigned char> set) {
+			(void)items; (void)active; (void)set;
+		};
+		void patrons(std::vector<const char*> names) { (void)names; };
+		void game_over() {};
+		char get_input();
+	protected:
+		void copy_notice() {};
+	private:
+		std::string keys;
+		size_t next = 0;
+};
+
+#endif // NULLBOARD_H
@@ -0,0 +1,73 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "board/null.hpp"
+
+#ifndef RECORDINGBOARD_H
+#define RECORDINGBOARD_H
+
+/** @class RecordingBoard
+ *
+ * @brief User interface, that records frames instead of showing them.
+ *
+ * Every call to setup(w, h, m), update() and game_over() appends one record
+ * to a buffer. Records start with a type byte, followed by little endian
+ * fields:
+ * - 'M' maze: uint32 width, uint32 height, width * height action bitmasks
+ * - 'F' frame: uint32 px, py, rx, ry, seconds, steps, uint16 score, int16
+ *   energy, time_drain, step_drain, char synth_help
+ * - 'G' game over, without fields
+ *
+ * Input is scripted, like for NullBoard.
+ *
+ * @author Maxine Michalski
+ */
+class RecordingBoard : public NullBoard {
+	public:
+		/** @see NullBoard::NullBoard() */
+		RecordingBoard(std::string keys) : NullBoard(keys) {};
+		/** @see Board for more information on any method */
+		void setup(unsigned int w, unsigned int h, std::vector<char> m);
+		void update();
+		void game_over();
+		/** @brief All records so far */
+		const std::vector<unsigned char> &records() { return buffer; };
+		/** @brief Number of 'F' records so far */
+		size_t frames() { return frame_count; };
+		/** @brief Write all records to a file
+		 *
+		 * @param const char* path - File to write
+		 *
+		 * @notice This method sets `error_message` on failure.
+		 *
+		 * @return true on success
+		 */
+		bool save(const char *path);
+	private:
+		/** @brief Append a little endian integer of n bytes */
+		void put(uint32_t v, unsigned int n);
+		std::vector<unsigned char> buffer;
+		size_t frame_count = 0;
+};
+
+#endif // RECORDINGBOARD_H
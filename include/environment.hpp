@@ -17,6 +17,7 @@
  *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstdint>
 #include <vector>
 
 #ifndef ENVIRONMENT_H
@@ -42,11 +43,11 @@ class Environment {
 		 * @param[in] bool with_reward - A setter to indicate that reward
 		 * placement (and thus path) should be changed too.
 		 *
-		 * @return new state in state encoding of an unsigned short
+		 * @return new state in state encoding of state()
 		 *
 		 * @notice This method changes internal values, which can be read after.
 		 */
-		virtual unsigned short reset(bool with_reward) = 0;
+		virtual uint64_t reset(bool with_reward) = 0;
 		/** @brief Perform an action, in the current environment.
 		 *
 		 * This method will test, if the action is valid and then transition
@@ -54,13 +55,13 @@ class Environment {
 		 *
 		 * @param[in] action Action bitmask, that is requested.
 		 *
-		 * @return new state in state encoding of an unsigned short
+		 * @return new state in state encoding of state()
 		 *
 		 * @notice This method changes internal values, which can be read after.
 		 * @notice If more than one action is required, via bitmask, then the
 		 * least significant bit action is executed only.
 		 */
-		virtual unsigned short act(unsigned char action) = 0;
+		virtual uint64_t act(unsigned char action) = 0;
 		/** @brief Bitmask encoded valid actions
 		 *
 		 * This method returns an 8 bit integer, that encodes valid actions (for
@@ -78,58 +79,124 @@ class Environment {
 		virtual unsigned char valid_actions() = 0;
 		/** @brief Return current state information
 		 *
-		 * State information are encoded inside an unsigned short.
+		 * State information are encoded inside a 64 bit integer.
 		 *
-		 * @notice The x coordinate is in the left hand byte, while the y
-		 * coordinate is in the right hand byte.
+		 * @notice The x coordinate is in the upper 32 bits, while the y
+		 * coordinate is in the lower 32 bits.
 		 *
-		 * @return unsigned short with positional state information.
+		 * @return uint64_t with positional state information.
 		 */
-		unsigned short state() { return (x<<8)|y; };
+		uint64_t state() { return encode(x, y); };
 		/** @brief Reward position indicator
 		 *
 		 * This method returns the current reward position.
 		 *
 		 * @notice Encoding is the same as in state()
 		 *
-		 * @return unsigned short with positional information.
+		 * @return uint64_t with positional information.
 		 */
-		unsigned short reward_position() { return (reward_x<<8)|reward_y; };
+		uint64_t reward_position() { return encode(reward_x, reward_y); };
+		/** @brief Encode a position, the same way as state() does */
+		static uint64_t encode(uint32_t x, uint32_t y) {
+			return (static_cast<uint64_t>(x)<<32)|y;
+		};
+		/** @brief X coordinate of an encoded position */
+		static uint32_t decode_x(uint64_t s) { return s>>32; };
+		/** @brief Y coordinate of an encoded position */
+		static uint32_t decode_y(uint64_t s) { return s&0xffffffff; };
 		/** @brief Current reward from last action/state pair */
 		int reward() { return _reward; }
 		/** @brief Playfield witdh in tiles */
 		int width() { return _width; };
 		/** @brief Playfield height in tiles */
 		int height() { return _height; };
-		/** @brief Return the entire map as data */
-		std::vector<char> nodes() { return map; };
+		/** @brief Return the entire map as data
+		 *
+		 * Every node is unpacked to a bitmask of open directions, encoded the
+		 * same way as valid_actions(). Nodes are ordered column by column.
+		 */
+		std::vector<char> nodes() {
+			std::vector<char> m(_width * _height);
+			int cx, cy;
+			for (cx = 0; cx < _width; cx++) {
+				for (cy = 0; cy < _height; cy++) {
+					m[cx * _height + cy] = map_get(cx, cy);
+				}
+			}
+			return m;
+		};
+		/** @brief Open directions of a single node
+		 *
+		 * @param[in] uint32_t i - Node index (x * height + y)
+		 *
+		 * @return char bitmask, encoded the same way as valid_actions()
+		 */
+		char node(uint32_t i) {
+			char v = passages(i)<<1;
+			if (i % _height > 0 && (passages(i - 1) & 0x02)) { v |= 0x01; }
+			if (i >= static_cast<uint32_t>(_height) &&
+					(passages(i - _height) & 0x01)) {
+				v |= 0x08;
+			}
+			return v;
+		};
+		/** @brief Raw map data, in packed format
+		 *
+		 * @see map for the format, which takes (width * height + 3) / 4
+		 * bytes.
+		 */
+		const unsigned char *packed() {
+			return view != nullptr ? view : map.data();
+		};
 	protected:
-		/** @brief Internal helper function, to set map node values
+		/** @brief Internal helper function, to get map node values
 		 *
-		 * @param[in] char x - X coordinate, to change value of
-		 * @param[in] char y - Y coordinate, to change value of
-		 * @param[in] char v - Value, used for change
+		 * @param[in] uint32_t x - X coordinate, to fetch value from
+		 * @param[in] uint32_t y - Y coordinate, to fetch value from
 		 *
-		 * @notice This method only sets bit masks, ORing them with the current
-		 * value, that is present already.
+		 * @return char bitmask of open directions for requested node
 		 */
-		void map_set(char x, char y, char v) { map[x * _height + y] |= v; };
-		/** @brief Internal helper function, to get map node values
+		char map_get(uint32_t x, uint32_t y) { return node(x * _height + y); };
+		/** @brief Open passages of a node, in packed map format
 		 *
-		 * @param[in] char x - X coordinate, to fetch value from
-		 * @param[in] char y - Y coordinate, to fetch value from
+		 * @param[in] uint32_t i - Node index (x * height + y)
 		 *
-		 * @return char value of requested node
+		 * @return 0x01 if the node is open to the east and 0x02 if the node is
+		 * open to the south
 		 */
-		char map_get(char x, char y) { return map[x * _height + y]; };
+		unsigned char passages(uint32_t i) {
+			return (packed()[i>>2] >> ((i&3)<<1)) & 0x03;
+		};
+		/** @brief Open passages of a node, in packed map format
+		 *
+		 * @param[in] uint32_t i - Node index (x * height + y)
+		 * @param[in] unsigned char v - 0x01 for east, 0x02 for south
+		 */
+		void open(uint32_t i, unsigned char v) {
+			map[i>>2] |= v << ((i&3)<<1);
+		};
 		/** @brief internal variable to hold information about current reward */
 		float _reward = 0;
 		/** @brief internal variables for map with and height specifications */
 		int _width, _height;
 		/** @brief internal variables to hold position information */
-		char x, y, reward_x, reward_y;
-		/** @brief internal variable for all map data */
-		std::vector<char> map;
+		uint32_t x, y, reward_x, reward_y;
+		/** @brief internal variable for all map data
+		 *
+		 * Walls are shared by neighboring nodes, so only passages to the east
+		 * and south are stored, with 2 bits per node (4 nodes per byte).
+		 *
+		 * @notice Environments may move this into shared storage, once it is
+		 * built, and use view instead.
+		 */
+		std::vector<unsigned char> map;
+		/** @brief Map data, that is owned by someone else
+		 *
+		 * If set, it is used instead of map, which stays empty then. This
+		 * allows to use mazes straight from memory mapped files or layouts,
+		 * that are shared between environments.
+		 */
+		const unsigned char *view = nullptr;
 };
 
 #endif // ENVIRONMENT_H
@@ -0,0 +1,186 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "environment/maze.hpp"
+
+#ifndef CORPUS_H
+#define CORPUS_H
+
+/* Binary corpus file format
+ *
+ * All numbers are little-endian. Files are written and read in place, without
+ * any conversion, so open() refuses to work on big-endian hosts.
+ *
+ * A file starts with a CorpusHeader, followed
+ * by all mazes and ends with an index of count 64 bit file offsets, one per
+ * maze, starting at the header's index offset.
+ *
+ * Every maze is a CorpusRecord followed by its map data, in the format of
+ * Environment::packed(). Records start at 8 byte boundaries, so a memory
+ * mapped file can be read in place.
+ */
+#define CORPUS_MAGIC "AMAZED\x1a\x0a"
+#define CORPUS_VERSION 1
+
+/** @brief Corpus file header */
+struct CorpusHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t reserved;
+	/** @brief Number of mazes */
+	uint64_t count;
+	/** @brief File offset of the maze index */
+	uint64_t index;
+};
+
+/** @brief Header of a single maze inside a corpus */
+struct CorpusRecord {
+	uint32_t width;
+	uint32_t height;
+	uint64_t seed;
+	/** @brief Generation algorithm (see Maze) */
+	char method;
+	char reserved[7];
+};
+
+/** @class CorpusWriter
+ *
+ * @brief Writes mazes to a corpus file.
+ *
+ * Mazes are streamed to the file through a large buffer, the index is kept in
+ * memory and written by close().
+ *
+ * @author Maxine Michalski
+ */
+class CorpusWriter {
+	public:
+		CorpusWriter() {};
+		/** @brief Deconstructor, that closes the file, if still open */
+		~CorpusWriter() { close(); };
+		/** @brief Create a new corpus file
+		 *
+		 * @param const char* path - File to write to
+		 *
+		 * @notice This method sets `error_message` on failure.
+		 *
+		 * @return true on success, false otherwise
+		 */
+		bool open(const char *path);
+		/** @brief Append a maze
+		 *
+		 * @notice This method sets `error_message` on failure.
+		 *
+		 * @return true on success, false otherwise
+		 */
+		bool add(Maze &maze);
+		/** @brief Append already serialized mazes
+		 *
+		 * Writes all records in one go, which allows to serialize mazes in
+		 * parallel.
+		 *
+		 * @param const std::vector<unsigned char>& records - Records, as
+		 * created by serialize()
+		 *
+		 * @notice This method sets `error_message` on failure.
+		 *
+		 * @return true on success, false otherwise
+		 */
+		bool add(const std::vector<unsigned char> &records);
+		/** @brief Append the record of a maze to a buffer
+		 *
+		 * @param Maze& maze - Maze to serialize
+		 * @param std::vector<unsigned char>& out - Buffer to append to
+		 */
+		static void serialize(Maze &maze, std::vector<unsigned char> &out);
+		/** @brief Write the index and close the file
+		 *
+		 * @notice This method sets `error_message` on failure.
+		 *
+		 * @return true on success, false otherwise
+		 */
+		bool close();
+		/** @brief Variable to hold error messages */
+		std::string error_message;
+	private:
+		/** @brief Write raw bytes and keep track of the file offset */
+		bool write(const void *data, size_t size);
+		FILE *file = nullptr;
+		uint64_t offset = 0;
+		std::vector<uint64_t> index;
+		/** @brief Reused buffer for add(Maze&) */
+		std::vector<unsigned char> scratch;
+};
+
+/** @class Corpus
+ *
+ * @brief Read only access to a corpus file.
+ *
+ * The file is memory mapped and mazes are handed out as views on it, so
+ * nothing is copied or generated, and processes reading the same corpus share
+ * it through the page cache.
+ *
+ * @author Maxine Michalski
+ */
+class Corpus {
+	public:
+		Corpus() {};
+		/** @brief Deconstructor, that unmaps the file */
+		~Corpus() { close(); };
+		/** @brief Map a corpus file
+		 *
+		 * @param const char* path - File to read from
+		 *
+		 * @notice This method sets `error_message` on failure.
+		 *
+		 * @return true on success, false otherwise
+		 */
+		bool open(const char *path);
+		/** @brief Unmap the file, all views become invalid */
+		void close();
+		/** @brief Number of mazes in this corpus */
+		uint64_t size() { return count; };
+		/** @brief View on a single maze
+		 *
+		 * @param uint64_t i - Index of the maze
+		 *
+		 * @return Maze* owned by the caller, that reads from the mapped file,
+		 * or nullptr if the record is broken (sets `error_message`), like
+		 * for unknown algorithms or passages leading out of the map
+		 *
+		 * @notice A view must not be used after its corpus is closed.
+		 */
+		Maze *at(uint64_t i);
+		/** @brief Variable to hold error messages */
+		std::string error_message;
+	private:
+		const unsigned char *data = nullptr;
+		uint64_t length = 0, count = 0;
+		const uint64_t *index = nullptr;
+#ifdef WINDOWS
+		/* No mmap on Windows, so the file is read to memory */
+		std::vector<unsigned char> buffer;
+#endif
+};
+
+#endif // CORPUS_H
@@ -0,0 +1,86 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include "environment.hpp"
+
+#ifndef DISTANCE_H
+#define DISTANCE_H
+
+/** @class DistanceField
+ *
+ * @brief Shortest path distances from one node to all others.
+ *
+ * Computed with a single breadth-first search. The search queue already lists
+ * nodes ordered by distance, so it is kept, together with the position where
+ * each distance starts. That allows to pick nodes inside a distance band in
+ * constant time.
+ *
+ * @notice Buffers are reused by every compute(), so recomputing a field of the
+ * same size doesn't allocate.
+ *
+ * @author Maxine Michalski
+ */
+class DistanceField {
+	public:
+		/** @brief Compute distances
+		 *
+		 * @param[in] Environment& env - Map to search
+		 * @param[in] uint32_t source - Node index (x * height + y) to start from
+		 */
+		void compute(Environment &env, uint32_t source);
+		/** @brief Distance of a node from source
+		 *
+		 * @param[in] uint32_t i - Node index
+		 *
+		 * @return uint32_t number of steps, or UINT32_MAX if unreachable
+		 */
+		uint32_t distance(uint32_t i) const { return dist[i]; };
+		/** @brief Biggest distance of any reachable node */
+		uint32_t max_distance() const { return first.size() - 2; };
+		/** @brief Number of nodes within a distance band
+		 *
+		 * @param[in] uint32_t lo - Smallest distance (inclusive)
+		 * @param[in] uint32_t hi - Biggest distance (inclusive)
+		 *
+		 * @notice Bands are clipped to max_distance().
+		 */
+		uint32_t count(uint32_t lo, uint32_t hi) const;
+		/** @brief Node within a distance band
+		 *
+		 * @param[in] uint32_t lo - Smallest distance of the band
+		 * @param[in] uint32_t k - Position inside the band, below count()
+		 *
+		 * @return uint32_t node index
+		 */
+		uint32_t pick(uint32_t lo, uint32_t k) const {
+			return order[first[lo] + k];
+		};
+	private:
+		/** @brief Distance per node */
+		std::vector<uint32_t> dist;
+		/** @brief Reachable nodes, ordered by distance */
+		std::vector<uint32_t> order;
+		/** @brief Position in order, where each distance starts (plus end) */
+		std::vector<uint32_t> first;
+};
+
+#endif // DISTANCE_H
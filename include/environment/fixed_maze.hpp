@@ -0,0 +1,145 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <vector>
+
+#include "environment.hpp"
+#include "environment/maze.hpp"
+#include "random.hpp"
+
+#ifndef FIXEDMAZE_H
+#define FIXEDMAZE_H
+
+/** @class StaticEnvironment
+ *
+ * @brief Compile time counterpart of Environment.
+ *
+ * A CRTP base for environments, whose size is known at compile time. Derived
+ * classes provide reset(), act() and valid_actions() like Environment does,
+ * but without virtual calls, so loops over them inline completely.
+ *
+ * Derived classes have to implement:
+ * - uint64_t reset(bool with_reward)
+ * - uint64_t act(unsigned char action)
+ * - unsigned char valid_actions()
+ *
+ * @author Maxine Michalski
+ */
+template <typename Derived, int W, int H> class StaticEnvironment {
+	public:
+		/** @brief Playfield width in tiles */
+		static constexpr int width() { return W; };
+		/** @brief Playfield height in tiles */
+		static constexpr int height() { return H; };
+		/** @see Environment::state() */
+		uint64_t state() { return Environment::encode(pos / H, pos % H); };
+		/** @see Environment::reward_position() */
+		uint64_t reward_position() {
+			return Environment::encode(goal / H, goal % H);
+		};
+		/** @brief Reward from last action */
+		int reward() { return _reward; };
+		/** @brief Perform a sequence of actions
+		 *
+		 * @param[in] const unsigned char* actions - Actions to perform
+		 * @param[in] size_t n - Number of actions
+		 *
+		 * @return int sum of all rewards
+		 */
+		int play(const unsigned char *actions, size_t n) {
+			size_t i;
+			int total = 0;
+			for (i = 0; i < n; i++) {
+				self().act(actions[i]);
+				total += _reward;
+			}
+			return total;
+		};
+	protected:
+		Derived &self() { return static_cast<Derived&>(*this); };
+		/** @brief Node indices (x * H + y) of player and reward */
+		uint32_t pos, goal;
+		int _reward = 0;
+};
+
+/** @class FixedMaze
+ *
+ * @brief Maze, with its size fixed at compile time.
+ *
+ * Follows the rules of Maze, but keeps one action bitmask per node in a
+ * std::array. With constant dimensions, the compiler turns all index math
+ * into shifts and multiplications by constants.
+ *
+ * @notice Rewards are placed uniformly on any node but the start, which is
+ * the default band of Maze. Placements are the same as for a Maze with the
+ * same seed.
+ *
+ * @author Maxine Michalski
+ */
+template <int W, int H> class FixedMaze :
+	public StaticEnvironment<FixedMaze<W, H>, W, H> {
+	public:
+		/** @brief initializer method
+		 *
+		 * @param char method - Algorithm to create maze (see Maze)
+		 * @param uint64_t seed - Seed for maze layout and reward placements
+		 */
+		FixedMaze(char method, uint64_t seed) :
+				rng(seed ^ Maze::REWARD_STREAM) {
+			Maze maze(W, H, method, seed);
+			std::vector<char> m = maze.nodes();
+			size_t i;
+			for (i = 0; i < CELLS; i++) { nodes[i] = m[i]; }
+			reset(true);
+		};
+		/** @see Environment::reset() */
+		uint64_t reset(bool with_reward) {
+			if (with_reward) {
+				// skip the start node
+				this->goal = rng.below(CELLS - 1);
+				if (CELLS > 1 && this->goal >= START) { this->goal++; }
+			}
+			this->pos = START;
+			this->_reward = 0;
+			return this->state();
+		};
+		/** @see Environment::act() */
+		uint64_t act(unsigned char action) {
+			this->pos += move(nodes[this->pos] & action);
+			this->_reward = this->pos == this->goal ? 100 : 0;
+			return this->state();
+		};
+		/** @see Environment::valid_actions() */
+		unsigned char valid_actions() { return nodes[this->pos]; };
+	private:
+		static constexpr size_t CELLS = W * H;
+		static constexpr uint32_t START = (W / 2) * H + H / 2;
+		/** @brief Node index change of an action bitmask */
+		static constexpr int32_t move(unsigned char a) {
+			return a == 0x01 ? -1 : a == 0x02 ? H : a == 0x04 ? 1 :
+				a == 0x08 ? -H : 0;
+		};
+		std::array<unsigned char, W * H> nodes;
+		Random rng;
+};
+
+#endif // FIXEDMAZE_H
@@ -0,0 +1,110 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include "environment.hpp"
+
+#ifndef JUNCTIONS_H
+#define JUNCTIONS_H
+
+/** @class JunctionGraph
+ *
+ * @brief Maze, with all corridors collapsed into weighted edges.
+ *
+ * Graph nodes are junctions and dead ends (every map node, that doesn't have
+ * exactly two open directions). Edges are the corridors between them,
+ * weighted by their length in steps. Corridor nodes remember their edge and
+ * position on it, so runs can start anywhere.
+ *
+ * @author Maxine Michalski
+ */
+class JunctionGraph {
+	public:
+		/** @brief A corridor between two graph nodes */
+		struct Edge {
+			/** @brief Graph nodes at both ends */
+			uint32_t a, b;
+			/** @brief Number of steps from a to b */
+			uint32_t length;
+			/** @brief Direction (0 up, 1 right, 2 down, 3 left) leaving a */
+			unsigned char leave_a;
+		};
+		/** @brief Value for missing edges and nodes */
+		static const uint32_t NONE = UINT32_MAX;
+		/** @brief Build the graph of a map
+		 *
+		 * @param[in] Environment& env - Map to build from
+		 */
+		void build(Environment &env);
+		/** @brief Follow a corridor to its end
+		 *
+		 * @param[in] uint32_t from - Map node index (x * height + y) to start at
+		 * @param[in] char dir - Direction (0 up, 1 right, 2 down, 3 left),
+		 * which has to be open at from
+		 * @param[in] uint32_t stop - Map node index to stop at, if passed by
+		 * (like a reward), or NONE
+		 * @param[out] uint32_t& to - Map node index, where the run ended
+		 *
+		 * @return uint32_t steps taken, 0 if dir is blocked
+		 */
+		uint32_t run(uint32_t from, char dir, uint32_t stop, uint32_t &to);
+		/** @brief Number of graph nodes */
+		uint32_t node_count() { return cells.size(); };
+		/** @brief Number of graph edges */
+		uint32_t edge_count() { return edges.size(); };
+		/** @brief Map node index of a graph node */
+		uint32_t cell(uint32_t node) { return cells[node]; };
+		/** @brief Edge leaving a graph node in a direction, or NONE */
+		uint32_t edge_at(uint32_t node, char dir) { return links[node * 4 + dir]; };
+		/** @brief A single edge */
+		const Edge &edge(uint32_t e) { return edges[e]; };
+	private:
+		/** @brief Make a map node a graph node */
+		void add(uint32_t cell);
+		/** @brief Trace all corridors of a graph node, not traced yet */
+		void connect(Environment &env, uint32_t node);
+		/** @brief Walk a corridor, starting at graph node a */
+		void trace(Environment &env, uint32_t a, char dir);
+		/** @brief Map node index of a neighbor */
+		uint32_t step(uint32_t cell, char dir) {
+			switch (dir) {
+				case 0: return cell - 1;
+				case 1: return cell + height;
+				case 2: return cell + 1;
+			}
+			return cell - height;
+		};
+		uint32_t height;
+		std::vector<Edge> edges;
+		/** @brief Map node index per graph node */
+		std::vector<uint32_t> cells;
+		/** @brief Edge per graph node and direction */
+		std::vector<uint32_t> links;
+		/** @brief Graph node (junctions) or edge (corridors) per map node */
+		std::vector<uint32_t> owner;
+		/** @brief Steps from edge end a, per corridor node (NONE for graph
+		 * nodes) */
+		std::vector<uint32_t> offset;
+		/** @brief Direction towards edge end b, per corridor node */
+		std::vector<unsigned char> toward_b;
+};
+
+#endif // JUNCTIONS_H
@@ -17,14 +17,26 @@
  *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <cstdlib>
-#include <ctime>
+#include <cstdint>
+#include <climits>
 #include <algorithm>
+#include <memory>
 
 #include "environment.hpp"
+#include "random.hpp"
+#include "environment/distance.hpp"
+#include "environment/junctions.hpp"
+#include "environment/topology.hpp"
 
 #ifndef MAZE_H
-#define iMAZE_H
+#define MAZE_H
+
+/** @brief Agent state of a maze (see Maze::snapshot()) */
+struct MazeState {
+	uint32_t x, y, reward_x, reward_y;
+	/** @brief State of reward placements */
+	Random rng;
+};
 
 /** @class Maze
  *
@@ -48,6 +60,10 @@
  *   - 300 energy are added (until max cap is reached)
  *   - power drain is increased by 1, every 15 seconds
  *
+ * @notice The maze layout is an immutable Topology, that is shared by all
+ * copies of a maze. Copying a maze (or snapshot() and restore()) only copies
+ * agent state, which makes branching for look-ahead search cheap.
+ *
  * @author Maxine Michalski
  */
 class Maze : public Environment {
@@ -63,21 +79,154 @@ class Maze : public Environment {
 		 *
 		 * @notice Supported maze generation algorithms are
 		 * - randomized depth-first search ('d')
+		 * - randomized Kruskal's algorithm ('k')
+		 * - randomized Prim's algorithm ('p')
+		 *
+		 * @notice The seed is taken from system entropy.
 		 */
 		Maze(int w, int h, char method);
+		/** @brief Seeded initializer method
+		 *
+		 * Same as above, but all randomness (maze layout and reward
+		 * placements) comes from the given seed, so runs can be replayed.
+		 *
+		 * @param uint64_t seed - Seed for this maze's random number generator
+		 */
+		Maze(int w, int h, char method, uint64_t seed);
+		/** @brief Initializer method, for mazes generated before
+		 *
+		 * Uses map data of an existing maze, without copying it. Reward
+		 * placements are the same as for the original maze, when it was
+		 * created with the same seed.
+		 *
+		 * @param const unsigned char* packed - Map data, in the format of
+		 * Environment::packed()
+		 *
+		 * @notice packed has to stay valid for the lifetime of this maze.
+		 */
+		Maze(int w, int h, char method, uint64_t seed,
+				const unsigned char *packed);
+		/** @brief Initializer method, for another agent in an existing maze
+		 *
+		 * Reward placements are the same as for the maze, that created the
+		 * topology.
+		 *
+		 * @param shared_ptr<const Topology> t - Layout to share
+		 */
+		Maze(std::shared_ptr<const Topology> t);
 		/** @see Environment::reset() */
-		unsigned short reset(bool with_reward);
+		uint64_t reset(bool with_reward);
 		/** @see Environment::act() */
-		unsigned short act(unsigned char action);
+		uint64_t act(unsigned char action);
 		/** @see Environment::valid_actions() */
 		unsigned char valid_actions();
+		/** @brief Run along a corridor, up to the next junction or dead end
+		 *
+		 * Takes the first step in the requested direction, then keeps
+		 * following the corridor, around its bends, until it reaches a
+		 * junction, a dead end or the reward, all in a single call. The
+		 * result matches repeated act() calls, each taking the only open way
+		 * other than back.
+		 *
+		 * @param[in] action Action bitmask, that is requested (see act())
+		 *
+		 * @return uint32_t number of steps taken, 0 if the action is invalid
+		 */
+		uint32_t run(unsigned char action);
+		/** @brief Junction graph of this maze, built on first use */
+		JunctionGraph &junctions();
+		/** @brief Seed, this maze was created with */
+		uint64_t seed() { return topology->seed(); };
+		/** @brief Algorithm, this maze was created with */
+		char method() { return topology->method(); };
+		/** @brief Layout of this maze, shared with all copies */
+		std::shared_ptr<const Topology> layout() { return topology; };
+		/** @brief Save agent state
+		 *
+		 * @return MazeState positions of player and reward and the state of
+		 * reward placements, without any map data
+		 */
+		MazeState snapshot();
+		/** @brief Go back to an agent state, saved by snapshot()
+		 *
+		 * @param const MazeState& s - State to restore, which has to come from
+		 * a maze with the same topology
+		 */
+		void restore(const MazeState &s);
+		/** @brief Limit reward placements to a distance band
+		 *
+		 * Rewards are placed on nodes, whose shortest path from start is
+		 * between lo and hi steps long. Bands beyond the farthest node are
+		 * moved to the farthest nodes.
+		 *
+		 * @param uint32_t lo - Smallest distance (default 1)
+		 * @param uint32_t hi - Biggest distance (default no limit)
+		 *
+		 * @notice Takes effect on the next reset(true).
+		 * @notice Bands other than the default need distances from start,
+		 * which are computed on first use.
+		 */
+		void reward_band(uint32_t lo, uint32_t hi) { band_lo = lo; band_hi = hi; };
+		/** @brief Number of steps of the shortest path from start to reward */
+		uint32_t optimal_steps() {
+			return topology->distances(*this).distance(
+					reward_x * _height + reward_y);
+		};
+		/** @brief Offset between maze and reward seeds */
+		static const uint64_t REWARD_STREAM = 0x5fa3c1e2d7b40963ULL;
+		/** @brief Biggest number of nodes, a maze can be generated with
+		 *
+		 * Generators index walls as node * 4 + direction, inside an int.
+		 */
+		static const int MAX_CELLS = INT_MAX / 4;
 	private:
-		/** @brief Randomized depth-first search algorithm */
+		/** @brief Random number generator, owned by this maze only */
+		Random rng;
+		/** @brief Map data, seed and distances from start */
+		std::shared_ptr<const Topology> topology;
+		uint32_t band_lo = 1, band_hi = UINT32_MAX;
+		/** @brief Junction graph, shared by copies made after it was built */
+		std::shared_ptr<JunctionGraph> graph;
+		/** @brief Randomized depth-first search algorithm
+		 *
+		 * Iterative recursive-backtracker, that stores its stack as parent
+		 * directions in one scratch byte per cell, so it is safe for mazes
+		 * with millions of cells.
+		 *
+		 * @param int x - X coordinate to start from
+		 * @param int y - Y coordinate to start from
+		 */
 		void depth_first(int x, int y);
-		/** @brief Randomized Kruskal's algorithm */
+		/** @brief Randomized Kruskal's algorithm
+		 *
+		 * Cells are tracked in a disjoint-set forest (union by size and path
+		 * compression), which keeps generation nearly linear in maze size.
+		 */
 		void kruskal();
-		/** @brief Randomized Prim's algorithm */
+		/** @brief Randomized Prim's algorithm
+		 *
+		 * Grows the maze from its center, by removing random walls between the
+		 * maze and cells outside of it. Cells with more walls towards the maze
+		 * are more likely to join, like in the original algorithm. Walls are
+		 * removed from the list by swapping them with the last entry, so each
+		 * pick takes constant time.
+		 */
 		void prim();
+		/** @brief Index of a neighboring cell
+		 *
+		 * @param int cell - Index of the cell to start from
+		 * @param char dir - Direction (0 up, 1 right, 2 down, 3 left)
+		 *
+		 * @return int index of the neighbor or -1, if it is outside the maze
+		 */
+		int neighbor(int cell, char dir);
+		/** @brief Remove the wall between a cell and its neighbor
+		 *
+		 * @param int cell - Index of the cell to start from
+		 * @param char dir - Direction of the wall (0 up, 1 right, 2 down, 3
+		 * left)
+		 */
+		void carve(int cell, char dir);
 };
 
 #endif // MAZE_H
@@ -0,0 +1,134 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "random.hpp"
+
+#ifndef MAZEBATCH_H
+#define MAZEBATCH_H
+
+/** @class MazeBatch
+ *
+ * @brief Many mazes, stepped together.
+ *
+ * Holds a number of equally sized mazes, with one agent each, in structure of
+ * arrays form. All agents are stepped with a single call over contiguous
+ * buffers, which avoids virtual calls and keeps memory access linear.
+ *
+ * Rules follow Maze, where reaching the power cell gives 100 reward and puts
+ * the agent back to the center, with a new power cell placement. Power cells
+ * are placed uniformly on any node but the start, like the default band of
+ * Maze. Every maze gets a seed of its own, and its layout and power cell
+ * placements are the same as for a Maze with that seed.
+ *
+ * @notice States are node indices (x * height + y), not the encoding used by
+ * Environment::state().
+ *
+ * @author Maxine Michalski
+ */
+class MazeBatch {
+	public:
+		/** @brief initializer method
+		 *
+		 * @param unsigned int n - Number of mazes
+		 * @param int w - Width of every maze
+		 * @param int h - Height of every maze
+		 * @param char method - Algorithm to create mazes (see Maze)
+		 * @param uint64_t seed - Seed for maze layouts and reward placements
+		 */
+		MazeBatch(unsigned int n, int w, int h, char method, uint64_t seed);
+		/** @brief Put all agents back to start
+		 *
+		 * @param[out] uint32_t* states - Buffer for n new states
+		 */
+		void reset(uint32_t *states);
+		/** @brief Perform one action in every maze
+		 *
+		 * Invalid actions leave an agent where it is. Agents that reach their
+		 * power cell are reset automatically, so the returned state is already
+		 * the start of a new episode.
+		 *
+		 * @param[in] const uint8_t* actions - n action bitmasks (see
+		 * Environment::act())
+		 * @param[out] uint32_t* states - Buffer for n new states
+		 * @param[out] float* rewards - Buffer for n rewards
+		 * @param[out] uint8_t* done - Buffer for n end of episode flags
+		 */
+		void step(const uint8_t *actions, uint32_t *states, float *rewards,
+				uint8_t *done);
+		/** @brief Valid actions of every agent
+		 *
+		 * @param[out] uint8_t* masks - Buffer for n action bitmasks (see
+		 * Environment::valid_actions())
+		 */
+		void valid_actions(uint8_t *masks);
+		/** @brief Replace a maze with a newly generated one
+		 *
+		 * The agent of that maze is put back to start, with a new power cell
+		 * placement.
+		 *
+		 * @param unsigned int i - Index of the maze to replace
+		 */
+		void regenerate(unsigned int i);
+		/** @brief Seed of maze i (see Maze::seed()) */
+		uint64_t seed(unsigned int i) { return seeds[i]; };
+		/** @brief Number of mazes in this batch */
+		unsigned int size() { return n; };
+		/** @brief Maze width in tiles */
+		int width() { return _width; };
+		/** @brief Maze height in tiles */
+		int height() { return _height; };
+	private:
+		/** @brief Valid actions at a node of maze i */
+		uint8_t node(unsigned int i, uint32_t cell) {
+			return (maps[static_cast<size_t>(i) * stride + (cell>>1)] >>
+					((cell&1)<<2)) & 0x0f;
+		};
+		/** @brief Random node index for a power cell of maze i, skipping the
+		 * start (like Maze::reset())
+		 */
+		uint32_t place(unsigned int i) {
+			uint32_t cells = _width * _height;
+			uint32_t cell = placements[i].below(cells - 1);
+			if (cells > 1 && cell >= start) { cell++; }
+			return cell;
+		};
+		unsigned int n;
+		int _width, _height;
+		char method;
+		/** @brief Bytes per maze, with two nodes per byte */
+		uint32_t stride;
+		/** @brief Node index of the starting point */
+		uint32_t start;
+		/** @brief Node index change for each action bitmask */
+		int32_t moves[16];
+		/** @brief Unpacked bitmasks of all mazes, back to back */
+		std::vector<uint8_t> maps;
+		std::vector<uint32_t> positions, rewards_at;
+		std::vector<uint64_t> seeds;
+		/** @brief Power cell placements of every maze */
+		std::vector<Random> placements;
+		/** @brief Seeds for new mazes */
+		Random rng;
+};
+
+#endif // MAZEBATCH_H
@@ -0,0 +1,84 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "ring.hpp"
+#include "random.hpp"
+#include "environment/maze.hpp"
+
+#ifndef MAZEPOOL_H
+#define MAZEPOOL_H
+
+/** @class MazePool
+ *
+ * @brief Mazes generated ahead of time, in a background thread.
+ *
+ * Keeps a few ready made mazes for every generation algorithm, so starting a
+ * game never has to wait for maze generation. A producer thread refills the
+ * queues, whenever a maze is taken out.
+ *
+ * @notice Every algorithm draws maze seeds from its own generator, so a seeded
+ * pool hands out the same mazes, no matter the timing.
+ *
+ * @author Maxine Michalski
+ */
+class MazePool {
+	public:
+		/** @brief initializer method, that starts the producer thread
+		 *
+		 * @param int w - Width of mazes
+		 * @param int h - Height of mazes
+		 * @param uint64_t seed - Seed, maze seeds are drawn from
+		 */
+		MazePool(int w, int h, uint64_t seed);
+		/** @brief Deconstructor, that stops the producer and frees mazes */
+		~MazePool();
+		/** @brief Take a ready made maze
+		 *
+		 * @param char method - Algorithm of the maze (see Maze)
+		 *
+		 * @return Maze*, owned by the caller from now on
+		 *
+		 * @notice Should the queue run dry, this waits for the producer.
+		 */
+		Maze *take(char method);
+	private:
+		/** @brief Producer thread main loop */
+		void produce();
+		/** @brief Queue index of an algorithm */
+		static int slot(char method);
+		static const char methods[3];
+		int width, height;
+		/** @brief Ready made mazes, for 'k', 'd' and 'p' */
+		Ring<Maze*, 4> ready[3];
+		/** @brief Seed sources per algorithm, only used by the producer */
+		Random rng[3];
+		/* Sleeping on full (producer) or empty (consumer) queues */
+		std::mutex mtx;
+		std::condition_variable taken, produced;
+		std::atomic<bool> stopping;
+		std::thread producer;
+};
+
+#endif // MAZEPOOL_H
@@ -0,0 +1,123 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "environment/maze_batch.hpp"
+
+#ifndef RUNNER_H
+#define RUNNER_H
+
+/** @class Runner
+ *
+ * @brief Thread pool, that steps many maze batches in parallel.
+ *
+ * Agents are split into shards, where each shard is a MazeBatch of its own.
+ * On every call, shards are handed out to worker threads round robin. Workers
+ * take shards from the back of their own queue and steal from the front of
+ * other queues, once theirs is empty, so shards that take longer (like maze
+ * regeneration) don't leave other cores idle.
+ *
+ * @notice Every shard owns its random number generator, so results are the
+ * same, no matter which worker picked up a shard.
+ *
+ * @author Maxine Michalski
+ */
+class Runner {
+	public:
+		/** @brief initializer method
+		 *
+		 * @param unsigned int shards - Number of shards
+		 * @param unsigned int n - Number of mazes per shard
+		 * @param int w - Width of every maze
+		 * @param int h - Height of every maze
+		 * @param char method - Algorithm to create mazes (see Maze)
+		 * @param uint64_t seed - Seed for all shards
+		 * @param unsigned int threads - Number of worker threads (0 for one per
+		 * core)
+		 * @param bool pin - Pin worker threads to a core each (Linux only)
+		 */
+		Runner(unsigned int shards, unsigned int n, int w, int h, char method,
+				uint64_t seed, unsigned int threads, bool pin);
+		/** @brief Deconstructor, that stops and joins all workers */
+		~Runner();
+		/** @brief Put all agents back to start
+		 *
+		 * @param[out] uint32_t* states - Buffer for size() new states
+		 */
+		void reset(uint32_t *states);
+		/** @brief Perform one action in every maze, in parallel
+		 *
+		 * @see MazeBatch::step() for buffer layouts, which cover all shards
+		 * back to back here.
+		 *
+		 * @param[out] uint8_t* observations - Buffer for size() valid action
+		 * bitmasks after the step, or nullptr if not needed
+		 */
+		void step(const uint8_t *actions, uint32_t *states, float *rewards,
+				uint8_t *done, uint8_t *observations);
+		/** @brief Generate a new maze, whenever an episode ends
+		 *
+		 * @param bool r - true, to regenerate mazes on episode end
+		 */
+		void regenerate(bool r) { regenerate_done = r; };
+		/** @brief Number of agents over all shards */
+		unsigned int size() { return batches.size() * per_shard; };
+		/** @brief Number of worker threads */
+		unsigned int threads() { return pool.size(); };
+	private:
+		/** @brief Queue of shards, waiting to be processed by a worker */
+		struct Queue {
+			std::mutex lock;
+			std::deque<unsigned int> shards;
+		};
+		/** @brief Worker thread main loop */
+		void work(unsigned int id, bool pin);
+		/** @brief Fetch next shard, from own queue or stolen from others */
+		bool next(unsigned int id, unsigned int &shard);
+		/** @brief Step a single shard */
+		void run(unsigned int shard);
+		std::vector<MazeBatch> batches;
+		std::vector<std::unique_ptr<Queue> > queues;
+		std::vector<std::thread> pool;
+		unsigned int per_shard;
+		/** @brief Number of cores, workers are pinned to */
+		unsigned int cores;
+		bool regenerate_done = false;
+		/* Synchronization between step() and workers */
+		std::mutex mtx;
+		std::condition_variable wake, finished;
+		unsigned long generation = 0;
+		std::atomic<unsigned int> pending;
+		bool stopping = false;
+		/* Buffers of the current step() call */
+		const uint8_t *actions;
+		uint32_t *states;
+		float *rewards;
+		uint8_t *done, *observations;
+};
+
+#endif // RUNNER_H
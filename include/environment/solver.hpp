@@ -0,0 +1,94 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "environment.hpp"
+
+#ifndef SOLVER_H
+#define SOLVER_H
+
+/** @class Solver
+ *
+ * @brief Bit-parallel breadth-first search.
+ *
+ * Passages, frontier and visited nodes are kept as bitboards, with one bit per
+ * node, stored row by row. Every search step expands the whole frontier with a
+ * few shifts and masks per 64 nodes, instead of visiting nodes one by one.
+ * With AVX2 available at runtime, 256 nodes are handled per instruction.
+ *
+ * Sweeps only pay off, while the frontier is dense. Narrow frontiers, like
+ * those along the corridors of depth-first mazes, are followed node by node
+ * from a queue instead, until they widen again.
+ *
+ * Rows are padded to whole words and walls to the east of the last column are
+ * always closed, so shifting the whole board by one bit never leaks nodes
+ * from one row into the next.
+ *
+ * @author Maxine Michalski
+ */
+class Solver {
+	public:
+		/** @brief Build bitboards for a map
+		 *
+		 * @param[in] Environment& env - Map to solve
+		 */
+		void load(Environment &env);
+		/** @brief Find a shortest path on the loaded map
+		 *
+		 * @param[in] uint32_t source - Node index (x * height + y) to start at
+		 * @param[in] uint32_t target - Node index (x * height + y) to reach
+		 * @param[out] vector<unsigned char>* path - If not nullptr, gets the
+		 * actions (see Environment::act()) leading from source to target
+		 *
+		 * @return uint32_t number of steps, or UINT32_MAX if unreachable
+		 */
+		uint32_t solve(uint32_t source, uint32_t target,
+				std::vector<unsigned char> *path);
+	private:
+		/** @brief Bit position of a node index */
+		size_t bit(uint32_t i) {
+			return (pad + (i % height) * words) * 64 + i / height;
+		};
+		bool test(const std::vector<uint64_t> &b, size_t p) {
+			return (b[p>>6] >> (p&63)) & 1;
+		};
+		int width, height;
+		/** @brief Words per row and zero words around the board */
+		size_t words, pad;
+		/** @brief Open passages to the east and south */
+		std::vector<uint64_t> east, south;
+		std::vector<uint64_t> frontier, next, visited;
+		/** @brief Bit positions of a narrow frontier and the nodes it found */
+		std::vector<size_t> queued, ahead;
+		/** @brief Band words per frontier node, above which the queue is used
+		 *
+		 * Sweeps hand over to the queue only below half this density, so
+		 * searches don't flip back and forth at the boundary.
+		 */
+		static const size_t SPARSE = 4;
+		/** @brief Fixed cost of a sweep, in words */
+		static const size_t SWEEP = 64;
+		/** @brief Nodes, whose parent is in direction up, right, down, left */
+		std::vector<uint64_t> back[4];
+};
+
+#endif // SOLVER_H
@@ -0,0 +1,100 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "environment/distance.hpp"
+
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+/** @class Topology
+ *
+ * @brief Layout of a maze, that never changes once generated.
+ *
+ * Holds map data and everything derived from it, which is the same for every
+ * agent in that maze. Mazes share their topology through a shared_ptr, so
+ * copies of a maze only copy agent state.
+ *
+ * @notice Distances from start take 8 bytes per node, against a quarter byte
+ * for map data, so they are only computed once they are asked for.
+ *
+ * @author Maxine Michalski
+ */
+class Topology {
+	public:
+		/** @brief initializer method, for map data owned by this topology
+		 *
+		 * @param int w - Width of maze
+		 * @param int h - Height of maze
+		 * @param char method - Algorithm, the maze was created with
+		 * @param uint64_t seed - Seed, the maze was created with
+		 * @param vector<unsigned char>&& map - Map data, in the format of
+		 * Environment::packed()
+		 */
+		Topology(int w, int h, char method, uint64_t seed,
+				std::vector<unsigned char> &&map) : _width(w), _height(h),
+				_method(method), _seed(seed), map(std::move(map)) {
+			view = this->map.data();
+		};
+		/** @brief initializer method, for map data owned by someone else
+		 *
+		 * @param const unsigned char* packed - Map data, which has to outlive
+		 * this topology
+		 */
+		Topology(int w, int h, char method, uint64_t seed,
+				const unsigned char *packed) : _width(w), _height(h),
+				_method(method), _seed(seed), view(packed) {};
+		Topology(const Topology&) = delete;
+		Topology &operator=(const Topology&) = delete;
+		/** @brief Map data (see Environment::packed()) */
+		const unsigned char *packed() const { return view; };
+		int width() const { return _width; };
+		int height() const { return _height; };
+		/** @brief Algorithm, the maze was created with */
+		char method() const { return _method; };
+		/** @brief Seed, the maze was created with */
+		uint64_t seed() const { return _seed; };
+		/** @brief Distances of all nodes from start, computed on first use
+		 *
+		 * @param Environment& env - Environment, that reads this topology's
+		 * map data
+		 *
+		 * @notice This method is thread safe.
+		 */
+		const DistanceField &distances(Environment &env) const {
+			std::call_once(computed, [this, &env]{
+				from_start.compute(env, (_width / 2) * _height + _height / 2);
+			});
+			return from_start;
+		};
+	private:
+		int _width, _height;
+		char _method;
+		uint64_t _seed;
+		std::vector<unsigned char> map;
+		const unsigned char *view;
+		mutable std::once_flag computed;
+		mutable DistanceField from_start;
+};
+
+#endif // TOPOLOGY_H
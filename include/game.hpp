@@ -0,0 +1,86 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+
+#include "environment.hpp"
+
+#ifndef GAME_H
+#define GAME_H
+
+// These are all game rule definitions and necessary to properly run Amazed
+#define MAX_ENERGY 1000
+#define MIN_ENERGY 0
+#define ENERGY_UP 300
+
+#define DRAIN_INTERVAL 15
+#define DRAIN_STEPS 100
+
+/** @class Game
+ *
+ * @brief Rules of Amazed, on top of an environment.
+ *
+ * Keeps track of energy, drains, time, steps and score of a single game.
+ * Nothing in here depends on real time or user interfaces, so recorded games
+ * can be simulated again as fast as possible.
+ *
+ * @notice See Maze for a description of all rules.
+ *
+ * @author Maxine Michalski
+ */
+class Game {
+	public:
+		/** @brief initializer method, that sets up a new game
+		 *
+		 * @param Environment* env - Environment to play in (not owned)
+		 */
+		Game(Environment *env);
+		/** @brief Move the player
+		 *
+		 * @param unsigned char action - Action bitmask (see Environment::act())
+		 *
+		 * @return bool true, if action was valid and the player moved
+		 */
+		bool act(unsigned char action);
+		/** @brief Let one second of game time pass */
+		void tick();
+		/** @brief true, once all energy is used up */
+		bool over() { return _energy <= 0; };
+		/** @brief State of player (see Environment::state()) */
+		uint64_t state() { return pos; };
+		Environment *environment() { return env; };
+		int energy() { return _energy; };
+		int time_drain() { return _time_drain; };
+		int step_drain() { return _step_drain; };
+		unsigned int seconds() { return _seconds; };
+		unsigned int steps() { return _steps; };
+		unsigned short score() { return _score; };
+	private:
+		/** @brief Keep energy between MIN_ENERGY and MAX_ENERGY */
+		void clip_energy();
+		Environment *env;
+		uint64_t pos;
+		int _energy;
+		int _time_drain, _step_drain, time_drain_increase, step_drain_increase;
+		int time_drain_counter, step_drain_counter;
+		unsigned int _seconds, _steps;
+		unsigned short _score;
+};
+
+#endif // GAME_H
@@ -0,0 +1,112 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <utility>
+
+#ifndef RANDOM_H
+#define RANDOM_H
+
+/** @class Random
+ *
+ * @brief Small and fast pseudo random number generator.
+ *
+ * An implementation of xoshiro256**, seeded through splitmix64. Every object
+ * owns its complete state, so generators in different threads never share
+ * anything and the same seed always produces the same numbers, on every
+ * platform.
+ *
+ * @author Maxine Michalski
+ */
+class Random {
+	public:
+		typedef uint64_t result_type;
+		/** @brief Initializer method
+		 *
+		 * @param uint64_t s - Seed to start from
+		 */
+		explicit Random(uint64_t s = 0) { seed(s); };
+		/** @brief Restart generator from a new seed
+		 *
+		 * @param uint64_t s - Seed to start from
+		 */
+		void seed(uint64_t s) {
+			int i;
+			for (i = 0; i < 4; i++) {
+				s += 0x9e3779b97f4a7c15ULL;
+				uint64_t z = s;
+				z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+				z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+				state[i] = z ^ (z >> 31);
+			}
+		};
+		/** @brief Next 64 bit random number */
+		uint64_t operator()() {
+			uint64_t result = rotl(state[1] * 5, 7) * 9, t = state[1] << 17;
+			state[2] ^= state[0];
+			state[3] ^= state[1];
+			state[1] ^= state[2];
+			state[0] ^= state[3];
+			state[2] ^= t;
+			state[3] = rotl(state[3], 45);
+			return result;
+		};
+		/** @brief Random number in range [0, n)
+		 *
+		 * Uses a multiply and shift instead of a modulo, which is faster and
+		 * has a negligible bias for ranges used here.
+		 *
+		 * @param uint32_t n - Upper bound (exclusive), must not be 0
+		 *
+		 * @return uint32_t random number below n
+		 */
+		uint32_t below(uint32_t n) {
+			return static_cast<uint32_t>(((*this)() >> 32) * n >> 32);
+		};
+		/** @brief Fisher-Yates shuffle of a random access range
+		 *
+		 * @notice Unlike std::shuffle, this gives the same order for the same
+		 * seed, on all standard libraries.
+		 */
+		template <typename It> void shuffle(It first, It last) {
+			uint32_t i, n = static_cast<uint32_t>(last - first);
+			for (i = n; i > 1; i--) {
+				std::swap(first[i - 1], first[below(i)]);
+			}
+		};
+		/** @brief Seed value from system entropy, for unseeded runs */
+		static uint64_t entropy() {
+			std::random_device device;
+			uint64_t s = (static_cast<uint64_t>(device()) << 32) ^ device();
+			return s ^ static_cast<uint64_t>(
+					std::chrono::high_resolution_clock::now().time_since_epoch()
+					.count());
+		};
+		static constexpr uint64_t min() { return 0; };
+		static constexpr uint64_t max() { return UINT64_MAX; };
+	private:
+		static uint64_t rotl(uint64_t v, int k) {
+			return (v << k) | (v >> (64 - k));
+		};
+		uint64_t state[4];
+};
+
+#endif // RANDOM_H
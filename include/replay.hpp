@@ -0,0 +1,143 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "game.hpp"
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+/* Binary replay file format
+ *
+ * All numbers are little-endian. A file starts with a ReplayHeader, followed
+ * by all actions with 2 bits each (direction 0 up, 1 right, 2 down, 3 left,
+ * four per byte, first action in the lowest bits). Timer ticks follow as
+ * LEB128 encoded differences of their action indices, where a tick at index
+ * i happened after i actions.
+ *
+ * Only valid actions are recorded, since invalid ones don't change a game.
+ */
+#define REPLAY_MAGIC "AMAZEDR\x1a"
+#define REPLAY_VERSION 1
+
+/** @brief Replay file header */
+struct ReplayHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t width;
+	uint32_t height;
+	/** @brief Generation algorithm (see Maze) */
+	char method;
+	char reserved[3];
+	/** @brief Seed of maze (see Maze::seed()) */
+	uint64_t seed;
+	/** @brief Number of actions */
+	uint64_t actions;
+	/** @brief Number of timer ticks */
+	uint64_t ticks;
+	/** @brief Final score, as recorded */
+	uint32_t score;
+	/** @brief Final time in seconds, as recorded */
+	uint32_t seconds;
+};
+
+/** @class Replay
+ *
+ * @brief Log of a single game, that can be played back.
+ *
+ * A game is fully defined by its maze seed, the order of all valid actions
+ * and the points in between them, where a second passed. Everything else,
+ * including reward placements, is simulated again on playback.
+ *
+ * @author Maxine Michalski
+ */
+class Replay {
+	public:
+		/** @brief Start recording a new game
+		 *
+		 * @param int w - Width of maze
+		 * @param int h - Height of maze
+		 * @param char method - Algorithm, the maze was created with
+		 * @param uint64_t seed - Seed, the maze was created with
+		 */
+		void start(int w, int h, char method, uint64_t seed);
+		/** @brief Record a valid action
+		 *
+		 * @param unsigned char action - Action bitmask with a single direction
+		 */
+		void action(unsigned char action);
+		/** @brief Record a timer tick, after all actions so far */
+		void tick() { ticks.push_back(count); };
+		/** @brief Record final result of game, for later verification */
+		void finish(unsigned int score, unsigned int seconds) {
+			header.score = score;
+			header.seconds = seconds;
+		};
+		/** @brief Write replay to a file
+		 *
+		 * @param const char* path - File to write to
+		 *
+		 * @notice This method sets `error_message` on failure.
+		 *
+		 * @return true on success
+		 */
+		bool save(const char *path);
+		/** @brief Read replay from a file
+		 *
+		 * @param const char* path - File to read from
+		 *
+		 * @notice This method sets `error_message` on failure.
+		 *
+		 * @return true on success
+		 */
+		bool load(const char *path);
+		/** @brief Simulate the whole game again
+		 *
+		 * @param Game& game - New game, on a maze created like the recorded one
+		 */
+		void play(Game &game);
+		/** @brief Number of recorded actions */
+		uint64_t size() { return count; };
+		/** @brief Action bitmask of action i */
+		unsigned char action_at(uint64_t i) {
+			return 1 << ((packed[i>>2] >> ((i&3)<<1)) & 3);
+		};
+		/** @brief Number of actions before each timer tick */
+		const std::vector<uint64_t> &tick_steps() { return ticks; };
+		int width() { return header.width; };
+		int height() { return header.height; };
+		char method() { return header.method; };
+		uint64_t seed() { return header.seed; };
+		/** @brief Final score, as recorded */
+		unsigned int score() { return header.score; };
+		/** @brief Final time in seconds, as recorded */
+		unsigned int seconds() { return header.seconds; };
+		/** @brief Variable to hold error messages */
+		std::string error_message;
+	private:
+		ReplayHeader header = {};
+		std::vector<unsigned char> packed;
+		std::vector<uint64_t> ticks;
+		uint64_t count = 0;
+};
+
+#endif // REPLAY_H
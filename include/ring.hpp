@@ -0,0 +1,87 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+
+#ifndef RING_H
+#define RING_H
+
+/** @class Ring
+ *
+ * @brief Bounded lock-free queue, for one producer and one consumer.
+ *
+ * A fixed size ring buffer, where the producer only ever moves the head and
+ * the consumer only ever moves the tail. Neither side takes a lock or waits
+ * for the other.
+ *
+ * @notice One slot is kept free to tell a full ring from an empty one, so a
+ * ring holds up to N-1 items.
+ *
+ * @author Maxine Michalski
+ */
+template <typename T, unsigned int N> class Ring {
+	public:
+		/** @brief Add an item (producer side only)
+		 *
+		 * @param[in] item - Item to add
+		 *
+		 * @return false if the ring is full, true otherwise
+		 */
+		bool push(const T &item) {
+			unsigned int h = head.load(std::memory_order_relaxed);
+			if ((h + 1) % N == tail.load(std::memory_order_acquire)) {
+				return false;
+			}
+			items[h] = item;
+			head.store((h + 1) % N, std::memory_order_release);
+			return true;
+		};
+		/** @brief Take the oldest item (consumer side only)
+		 *
+		 * @param[out] item - Item that was taken
+		 *
+		 * @return false if the ring is empty, true otherwise
+		 */
+		bool pop(T &item) {
+			unsigned int t = tail.load(std::memory_order_relaxed);
+			if (t == head.load(std::memory_order_acquire)) {
+				return false;
+			}
+			item = items[t];
+			tail.store((t + 1) % N, std::memory_order_release);
+			return true;
+		};
+		/** @brief Test if no more items fit in */
+		bool full() {
+			return (head.load(std::memory_order_acquire) + 1) % N ==
+				tail.load(std::memory_order_acquire);
+		};
+	private:
+		T items[N];
+		/* Keep both ends on their own cache line, so producer and consumer
+		 * don't slow each other down. Padding instead of alignas, since heap
+		 * allocations aren't over-aligned before C++17. */
+		char pad_items[64];
+		std::atomic<unsigned int> head{0};
+		char pad_head[64 - sizeof(std::atomic<unsigned int>)];
+		std::atomic<unsigned int> tail{0};
+		char pad_tail[64 - sizeof(std::atomic<unsigned int>)];
+};
+
+#endif // RING_H
@@ -0,0 +1,95 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+/** @class Snapshot
+ *
+ * @brief Value, that is published by writers and read without locks.
+ *
+ * A sequence lock, where the sequence is odd while a write is in progress.
+ * Readers copy the value and retry, if the sequence changed meanwhile, so
+ * they never block writers or each other. The value is stored in atomic
+ * words, so torn reads are detected instead of being undefined behaviour.
+ *
+ * @notice T has to be trivially copyable and writers have to serialize
+ * among themselves.
+ *
+ * @author Maxine Michalski
+ */
+template <typename T> class Snapshot {
+	public:
+		Snapshot() : sequence(0) {
+			size_t i;
+			for (i = 0; i < WORDS; i++) { words[i].store(0); }
+		};
+		/** @brief Publish a new value
+		 *
+		 * @param const T& value - Value to publish
+		 */
+		void publish(const T &value) {
+			uint64_t buffer[WORDS] = {0}, s = sequence.load(std::memory_order_relaxed);
+			size_t i;
+			std::memcpy(buffer, &value, sizeof(T));
+			sequence.store(s + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			for (i = 0; i < WORDS; i++) {
+				words[i].store(buffer[i], std::memory_order_relaxed);
+			}
+			sequence.store(s + 2, std::memory_order_release);
+		};
+		/** @brief Read latest published value
+		 *
+		 * @param[out] uint64_t* v - Version of returned value, if not nullptr
+		 *
+		 * @return T copy of value
+		 */
+		T read(uint64_t *v = nullptr) const {
+			uint64_t buffer[WORDS], before, after;
+			size_t i;
+			T value;
+			do {
+				before = sequence.load(std::memory_order_acquire);
+				for (i = 0; i < WORDS; i++) {
+					buffer[i] = words[i].load(std::memory_order_relaxed);
+				}
+				std::atomic_thread_fence(std::memory_order_acquire);
+				after = sequence.load(std::memory_order_relaxed);
+			} while ((before & 1) || before != after);
+			std::memcpy(&value, buffer, sizeof(T));
+			if (v != nullptr) { *v = before / 2; }
+			return value;
+		};
+		/** @brief Number of values published so far */
+		uint64_t version() const {
+			return sequence.load(std::memory_order_acquire) / 2;
+		};
+	private:
+		static const size_t WORDS = (sizeof(T) + 7) / 8;
+		std::atomic<uint64_t> sequence;
+		std::atomic<uint64_t> words[WORDS];
+};
+
+#endif // SNAPSHOT_H
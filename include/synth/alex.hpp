@@ -0,0 +1,83 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include "environment.hpp"
+#include "environment/distance.hpp"
+
+#ifndef ALEX_H
+#define ALEX_H
+
+/** @class Alex
+ *
+ * @brief The helper synth, that knows the way to the power cell.
+ *
+ * Whenever the power cell moves, Alex computes a DistanceField from it and
+ * remembers, for every node, which neighbor is one step closer. Hints are
+ * table lookups after that.
+ *
+ * @author Maxine Michalski
+ */
+class Alex {
+	public:
+		/** @brief Learn the way to the current reward
+		 *
+		 * Call this after every reset, that moved the reward.
+		 *
+		 * @param[in] Environment& env - Environment to learn
+		 *
+		 * @notice Buffers are reused, so this doesn't allocate for maps of the
+		 * same size.
+		 */
+		void learn(Environment &env);
+		/** @brief Best action for a state
+		 *
+		 * @param[in] uint64_t state - State, encoded like Environment::state()
+		 *
+		 * @return unsigned char action bitmask (see Environment::act()), or 0
+		 * if there is nothing to suggest
+		 */
+		unsigned char action(uint64_t state) {
+			return toward[Environment::decode_x(state) * height +
+				Environment::decode_y(state)];
+		};
+		/** @brief Hint to display for a state
+		 *
+		 * @return char arrow like character, pointing the way
+		 */
+		char hint(uint64_t state) {
+			switch (action(state)) {
+				case 0x01: return '^';
+				case 0x02: return '>';
+				case 0x04: return 'v';
+				case 0x08: return '<';
+			}
+			return ' ';
+		};
+	private:
+		int height = 0;
+		/** @brief Action, that leads closer to reward, per node */
+		std::vector<unsigned char> toward;
+		/** @brief Distances from reward */
+		DistanceField from_reward;
+};
+
+#endif // ALEX_H
@@ -18,6 +18,7 @@
  */
 
 #include <cstring>
+#include <algorithm>
 
 #include "board/curses.hpp"
 
@@ -25,8 +26,13 @@ CursesBoard::CursesBoard() {
 	initscr();
 }
 
+CursesBoard::CursesBoard(const char *type, FILE *out, FILE *in) {
+	screen = newterm(type, out, in);
+}
+
 CursesBoard::~CursesBoard() {
 	endwin();
+	if (screen != nullptr) { delscreen(screen); }
 }
 
 bool CursesBoard::capable() {
@@ -66,8 +72,20 @@ void CursesBoard::setup() {
 
 void CursesBoard::setup(unsigned int w, unsigned int h, std::vector<char> m) {
 	width = w; height = h; map = m;
-	board_win = newwin(height*2+3,  width*2+3, 0, 0);
-	stats_win = newwin(24-(height*2+3),  (width*2+3), height*2+3, 0);
+	int frame_w, frame_h;
+	if (board_win != nullptr) { delwin(board_win); }
+	if (stats_win != nullptr) { delwin(stats_win); }
+	if (pad != nullptr) { delwin(pad); }
+	// Mazes bigger than the terminal are shown through a viewport
+	frame_w = std::min<int>(COLS, std::max<int>(width*2+3, 79));
+	frame_h = std::min<int>(LINES-3, height*2+3);
+	view_w = std::min<int>(frame_w-2, width*2+1);
+	view_h = frame_h-2;
+	board_win = newwin(frame_h, frame_w, 0, 0);
+	stats_win = newwin(3, frame_w, frame_h, 0);
+	pad = newpad(height*2+1, width*2+1);
+	view_x = view_y = -1;
+	fresh = true;
 	clear();
 	refresh();
 }
@@ -75,9 +93,12 @@ void CursesBoard::setup(unsigned int w, unsigned int h, std::vector<char> m) {
 void CursesBoard::update() {
 	draw_stats();
 	draw_board();
-	refresh();
-	wrefresh(board_win);
-	wrefresh(stats_win);
+	fresh = false;
+	// Flush all windows to the terminal at once
+	wnoutrefresh(board_win);
+	pnoutrefresh(pad, view_y, view_x, 1, 1, view_h, view_w);
+	wnoutrefresh(stats_win);
+	doupdate();
 }
 void CursesBoard::menu(std::vector<const char*> items, unsigned char active, 
 		std::vector<unsigned char> set) {
@@ -152,85 +173,138 @@ char CursesBoard::get_input() {
 	return input;
 }
 
+void CursesBoard::draw_bar(int y, int x, int value, int cells) {
+	int i;
+	for (i = 0; i < value / 2; i++) {
+		mvwaddch(stats_win, y, x+i, ACS_CKBOARD|COLOR_PAIR(4));
+	}
+	if (value % 2) {
+		mvwaddch(stats_win, y, x+i++, ACS_CKBOARD|COLOR_PAIR(3));
+	}
+	for (; i < cells; i++) {
+		mvwaddch(stats_win, y, x+i, ' ');
+	}
+}
+
 void CursesBoard::draw_stats() {
 	int i;
-	werase(stats_win);
-	wborder(stats_win, 0, 0, ' ', 0, ACS_VLINE, ACS_VLINE, 0, 0);
-	for (i = 0; i < getmaxy(stats_win)-1; i++) {
-		mvwaddch(stats_win, i, 19, ACS_VLINE);
-		mvwaddch(stats_win, i, 42, ACS_VLINE);
-		mvwaddch(stats_win, i, 65, ACS_VLINE);
-	}
-	mvwaddch(stats_win, getmaxy(stats_win)-1, 19, ACS_BTEE);
-	mvwaddch(stats_win, getmaxy(stats_win)-1, 42, ACS_BTEE);
-	mvwaddch(stats_win, getmaxy(stats_win)-1, 65, ACS_BTEE);
-	mvwprintw(stats_win, 0, 1, "Score:  %d", score);
-	mvwaddstr(stats_win, 1, 1, "Energy: ");
-	for (i = 0; i < energy/2; i++) {
-		mvwaddch(stats_win, 1, 9+i, ACS_CKBOARD|COLOR_PAIR(4));
-	}
-	if (energy % 2) {
-		mvwaddch(stats_win, 1, 9+i++, ACS_CKBOARD|COLOR_PAIR(3));
-	}
-	mvwprintw(stats_win, 0, 20, "Time:  %02d:%02d", (seconds / 60) % 60,
-		   	seconds % 60);
-	mvwaddstr(stats_win, 1, 20, "Drain: ");
 	if (time_drain > 30) { time_drain = 30; }
-	for (i = 0; i < time_drain / 2; i++) {
-		mvwaddch(stats_win, 1, 27+i, ACS_CKBOARD|COLOR_PAIR(4));
+	if (step_drain > 30) { step_drain = 30; }
+	if (fresh) {
+		werase(stats_win);
+		wborder(stats_win, 0, 0, ' ', 0, ACS_VLINE, ACS_VLINE, 0, 0);
+		for (i = 0; i < getmaxy(stats_win)-1; i++) {
+			mvwaddch(stats_win, i, 19, ACS_VLINE);
+			mvwaddch(stats_win, i, 42, ACS_VLINE);
+			mvwaddch(stats_win, i, 65, ACS_VLINE);
+		}
+		mvwaddch(stats_win, getmaxy(stats_win)-1, 19, ACS_BTEE);
+		mvwaddch(stats_win, getmaxy(stats_win)-1, 42, ACS_BTEE);
+		mvwaddch(stats_win, getmaxy(stats_win)-1, 65, ACS_BTEE);
+		mvwaddstr(stats_win, 1, 1, "Energy: ");
+		mvwaddstr(stats_win, 1, 20, "Drain: ");
+		mvwaddstr(stats_win, 1, 43, "Drain: ");
+		mvwaddstr(stats_win, 0, 67, "Alex: ");
 	}
-	if (time_drain % 2) {
-		mvwaddch(stats_win, 1, 27+i++, ACS_CKBOARD|COLOR_PAIR(3));
+	// Fields are padded to their column, so shorter values clear longer ones
+	if (fresh || score != shown.score) {
+		mvwprintw(stats_win, 0, 1, "Score:  %-9d", score);
 	}
-	mvwprintw(stats_win, 0, 43, "Steps: %d", steps);
-	mvwaddstr(stats_win, 1, 43, "Drain: ");
-	if (step_drain > 30) { step_drain = 30; }
-	for (i = 0; i < step_drain / 2; i++) {
-		mvwaddch(stats_win, 1, 50+i, ACS_CKBOARD|COLOR_PAIR(4));
+	if (fresh || energy != shown.energy) {
+		draw_bar(1, 9, energy, 10);
+	}
+	if (fresh || seconds != shown.seconds) {
+		mvwprintw(stats_win, 0, 20, "Time:  %02d:%02d", (seconds / 60) % 60,
+				seconds % 60);
+	}
+	if (fresh || time_drain != shown.time_drain) {
+		draw_bar(1, 27, time_drain, 15);
+	}
+	if (fresh || steps != shown.steps) {
+		mvwprintw(stats_win, 0, 43, "Steps: %-14d", steps);
+	}
+	if (fresh || step_drain != shown.step_drain) {
+		draw_bar(1, 50, step_drain, 15);
 	}
-	if (step_drain % 2) {
-		mvwaddch(stats_win, 1, 50+i++, ACS_CKBOARD|COLOR_PAIR(3));
+	if (fresh || synth_help != shown.synth_help) {
+		mvwaddch(stats_win, 0, 73, synth_help);
 	}
-	mvwaddstr(stats_win, 0, 67, "Alex: ");
-	mvwaddch(stats_win, 0, 73, synth_help);
+	shown.score = score;
+	shown.energy = energy;
+	shown.seconds = seconds;
+	shown.time_drain = time_drain;
+	shown.steps = steps;
+	shown.step_drain = step_drain;
+	shown.synth_help = synth_help;
 }
 
 void CursesBoard::game_over() {
 	wattron(stats_win, A_BOLD);
 	mvwaddstr(stats_win, 0, 67, "Game Over!");
 	wattroff(stats_win, A_BOLD);
-	refresh();
-	wrefresh(board_win);
-	wrefresh(stats_win);
+	wnoutrefresh(board_win);
+	pnoutrefresh(pad, view_y, view_x, 1, 1, view_h, view_w);
+	wnoutrefresh(stats_win);
+	doupdate();
 }
 
-void CursesBoard::draw_board() {
-	unsigned int n = width * height, i, x, y;
+void CursesBoard::draw_maze() {
+	unsigned int x, y, cols = width*2+1;
 	chtype wall =	ACS_CKBOARD | COLOR_PAIR(1);
-	chtype player = ACS_CKBOARD | COLOR_PAIR(2);
 	chtype floor =	' ' | COLOR_PAIR(3);
+	std::vector<chtype> line(cols, wall);
 	werase(board_win);
 	wborder(board_win, 0, 0, 0, 0, 0, 0, ACS_LTEE, ACS_RTEE);
-	for (i = 0; i < n; i++) {
-		y = ((i % height)+1)*2;
-		x =	((i / height)+1)*2;
-		mvwaddch(board_win, y, x, floor);
-		mvwaddch(board_win, y-1, x-1, wall);
-		if (map[i] & 0x01) { mvwaddch(board_win, y-1, x, floor); }
-		else { mvwaddch(board_win, y-1, x, wall); }
-		mvwaddch(board_win, y-1, x+1, wall);
-		if (map[i] & 0x02) { mvwaddch(board_win, y, x+1, floor); }
-		else { mvwaddch(board_win, y, x+1, wall); }
-		mvwaddch(board_win, y+1, x+1, wall);
-		if (map[i] & 0x04) { mvwaddch(board_win, y+1, x, floor); }
-		else { mvwaddch(board_win, y+1, x, wall); }
-		mvwaddch(board_win, y+1, x-1, wall);
-		if (map[i] & 0x08) { mvwaddch(board_win, y, x-1, floor); }
-		else { mvwaddch(board_win, y, x-1, wall); }
-	}
-	mvwaddch(board_win, ((ry)+1)*2, (rx+1)*2, ACS_DIAMOND | COLOR_PAIR(3));
-	mvwaddch(board_win, ((py)+1)*2, ((px)+1)*2, player);
 	mvwaddch(board_win, getmaxy(board_win)-1, 19, ACS_TTEE);
 	mvwaddch(board_win, getmaxy(board_win)-1, 42, ACS_TTEE);
 	mvwaddch(board_win, getmaxy(board_win)-1, 65, ACS_TTEE);
+	// Pad rows are built as a whole, from east and south passages only
+	mvwaddchnstr(pad, 0, 0, line.data(), cols);
+	for (y = 0; y < height; y++) {
+		std::fill(line.begin(), line.end(), wall);
+		for (x = 0; x < width; x++) {
+			line[x*2+1] = floor;
+			if (map[x*height + y] & 0x02) { line[x*2+2] = floor; }
+		}
+		mvwaddchnstr(pad, y*2+1, 0, line.data(), cols);
+		std::fill(line.begin(), line.end(), wall);
+		for (x = 0; x < width; x++) {
+			if (map[x*height + y] & 0x04) { line[x*2+1] = floor; }
+		}
+		mvwaddchnstr(pad, y*2+2, 0, line.data(), cols);
+	}
+}
+
+void CursesBoard::follow() {
+	int x, y;
+	// Keep player centered, but don't scroll beyond the maze
+	x = std::max(0, std::min<int>(px*2+1 - view_w/2, width*2+1 - view_w));
+	y = std::max(0, std::min<int>(py*2+1 - view_h/2, height*2+1 - view_h));
+	if (x != view_x || y != view_y) {
+		view_x = x;
+		view_y = y;
+		touchwin(pad);
+	}
+}
+
+void CursesBoard::draw_board() {
+	chtype player = ACS_CKBOARD | COLOR_PAIR(2);
+	chtype floor =	' ' | COLOR_PAIR(3);
+	if (fresh) { draw_maze(); }
+	else if (px == shown.px && py == shown.py && rx == shown.rx &&
+			ry == shown.ry) {
+		return;
+	}
+	else {
+		// Only tiles can change, so restore old ones to floor first
+		mvwaddch(pad, shown.ry*2+1, shown.rx*2+1, floor);
+		mvwaddch(pad, shown.py*2+1, shown.px*2+1, floor);
+	}
+	mvwaddch(pad, ry*2+1, rx*2+1, ACS_DIAMOND | COLOR_PAIR(3));
+	mvwaddch(pad, py*2+1, px*2+1, player);
+	shown.px = px;
+	shown.py = py;
+	shown.rx = rx;
+	shown.ry = ry;
+	follow();
 }
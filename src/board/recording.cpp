@@ -0,0 +1,77 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+
+#include "board/recording.hpp"
+
+void RecordingBoard::put(uint32_t v, unsigned int n) {
+	unsigned int i;
+	for (i = 0; i < n; i++) {
+		buffer.push_back((v >> (i*8)) & 0xff);
+	}
+}
+
+void RecordingBoard::setup(unsigned int w, unsigned int h,
+		std::vector<char> m) {
+	NullBoard::setup(w, h, m);
+	buffer.push_back('M');
+	put(w, 4);
+	put(h, 4);
+	buffer.insert(buffer.end(), m.begin(), m.end());
+}
+
+void RecordingBoard::update() {
+	buffer.push_back('F');
+	put(px, 4);
+	put(py, 4);
+	put(rx, 4);
+	put(ry, 4);
+	put(seconds, 4);
+	put(steps, 4);
+	put(score, 2);
+	put(energy, 2);
+	put(time_drain, 2);
+	put(step_drain, 2);
+	buffer.push_back(synth_help);
+	frame_count++;
+}
+
+void RecordingBoard::game_over() {
+	buffer.push_back('G');
+}
+
+bool RecordingBoard::save(const char *path) {
+	bool ok;
+	FILE *f = fopen(path, "wb");
+	if (f == nullptr) {
+		error_message = std::string("Can't open ") + path + ": " +
+			strerror(errno);
+		return false;
+	}
+	ok = fwrite(buffer.data(), 1, buffer.size(), f) == buffer.size();
+	ok = fclose(f) == 0 && ok;
+	if (!ok) {
+		error_message = std::string("Can't write recording: ") +
+			strerror(errno);
+	}
+	return ok;
+}
@@ -0,0 +1,263 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#ifndef WINDOWS
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+
+#include "environment/corpus.hpp"
+
+static_assert(sizeof(CorpusHeader) == 32, "corpus header must be 32 bytes");
+static_assert(sizeof(CorpusRecord) == 24, "corpus record must be 24 bytes");
+
+/** @brief Test if numbers are stored little-endian on this host */
+static bool little_endian() {
+	const uint16_t probe = 1;
+	unsigned char first;
+	memcpy(&first, &probe, 1);
+	return first == 1;
+}
+
+/** @brief Bytes of map data in a record, without padding */
+static uint64_t packed_size(uint64_t w, uint64_t h) {
+	return (w * h + 3) / 4;
+}
+
+/** @brief Bytes of a whole record, with padding */
+static uint64_t record_size(uint64_t w, uint64_t h) {
+	return sizeof(CorpusRecord) + (packed_size(w, h) + 7) / 8 * 8;
+}
+
+/** @brief Test if map data has no passages leading out of the map
+ *
+ * Only east and south passages are stored, so only the last column and the
+ * last row need a check.
+ */
+static bool closed_borders(const unsigned char *m, uint64_t w, uint64_t h) {
+	uint64_t i;
+	for (i = (w - 1) * h; i < w * h; i++) {
+		if ((m[i>>2] >> ((i&3)<<1)) & 0x01) { return false; }
+	}
+	for (i = h - 1; i < w * h; i += h) {
+		if ((m[i>>2] >> ((i&3)<<1)) & 0x02) { return false; }
+	}
+	return true;
+}
+
+bool CorpusWriter::open(const char *path) {
+	CorpusHeader header = {};
+	close();
+	if (!little_endian()) {
+		error_message = "Corpus files need a little-endian host";
+		return false;
+	}
+	file = fopen(path, "wb");
+	if (file == nullptr) {
+		error_message = std::string("Can't open ") + path + ": " +
+			strerror(errno);
+		return false;
+	}
+	setvbuf(file, nullptr, _IOFBF, 1<<20);
+	offset = 0;
+	index.clear();
+	// header gets filled in by close(), once count and index are known
+	return write(&header, sizeof(header));
+}
+
+bool CorpusWriter::add(Maze &maze) {
+	scratch.clear();
+	serialize(maze, scratch);
+	return add(scratch);
+}
+
+bool CorpusWriter::add(const std::vector<unsigned char> &records) {
+	const CorpusRecord *record;
+	uint64_t at = 0;
+	if (file == nullptr) {
+		error_message = "Corpus is not open";
+		return false;
+	}
+	// walk all records, to put them into the index
+	while (at < records.size()) {
+		record = reinterpret_cast<const CorpusRecord*>(&records[at]);
+		index.push_back(offset + at);
+		at += record_size(record->width, record->height);
+	}
+	return write(records.data(), records.size());
+}
+
+void CorpusWriter::serialize(Maze &maze, std::vector<unsigned char> &out) {
+	CorpusRecord record = {};
+	uint64_t at = out.size();
+	record.width = maze.width();
+	record.height = maze.height();
+	record.seed = maze.seed();
+	record.method = maze.method();
+	// resize zero fills, which takes care of padding
+	out.resize(at + record_size(record.width, record.height), 0);
+	memcpy(&out[at], &record, sizeof(record));
+	memcpy(&out[at + sizeof(record)], maze.packed(),
+			packed_size(record.width, record.height));
+}
+
+bool CorpusWriter::close() {
+	CorpusHeader header = {};
+	bool ok;
+	if (file == nullptr) { return true; }
+	memcpy(header.magic, CORPUS_MAGIC, 8);
+	header.version = CORPUS_VERSION;
+	header.count = index.size();
+	header.index = offset;
+	ok = write(index.data(), index.size() * sizeof(uint64_t)) &&
+		fseek(file, 0, SEEK_SET) == 0 &&
+		fwrite(&header, sizeof(header), 1, file) == 1;
+	if (fclose(file) != 0) { ok = false; }
+	file = nullptr;
+	if (!ok && error_message.empty()) {
+		error_message = std::string("Can't write corpus: ") + strerror(errno);
+	}
+	return ok;
+}
+
+bool CorpusWriter::write(const void *data, size_t size) {
+	if (size > 0 && fwrite(data, size, 1, file) != 1) {
+		error_message = std::string("Can't write corpus: ") + strerror(errno);
+		return false;
+	}
+	offset += size;
+	return true;
+}
+
+bool Corpus::open(const char *path) {
+	const CorpusHeader *header;
+	close();
+	if (!little_endian()) {
+		error_message = "Corpus files need a little-endian host";
+		return false;
+	}
+#ifdef WINDOWS
+	FILE *file = fopen(path, "rb");
+	long size;
+	if (file == nullptr || fseek(file, 0, SEEK_END) != 0 ||
+			(size = ftell(file)) < 0 || fseek(file, 0, SEEK_SET) != 0) {
+		error_message = std::string("Can't open ") + path;
+		if (file != nullptr) { fclose(file); }
+		return false;
+	}
+	buffer.resize(size);
+	if (size > 0 && fread(buffer.data(), size, 1, file) != 1) {
+		error_message = std::string("Can't read ") + path;
+		fclose(file);
+		return false;
+	}
+	fclose(file);
+	data = buffer.data();
+	length = size;
+#else
+	struct stat info;
+	void *mapped;
+	int fd = ::open(path, O_RDONLY);
+	if (fd < 0 || fstat(fd, &info) != 0) {
+		error_message = std::string("Can't open ") + path + ": " +
+			strerror(errno);
+		if (fd >= 0) { ::close(fd); }
+		return false;
+	}
+	length = info.st_size;
+	mapped = length > 0 ? mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0) :
+		MAP_FAILED;
+	::close(fd);
+	if (mapped == MAP_FAILED) {
+		error_message = std::string("Can't map ") + path;
+		length = 0;
+		return false;
+	}
+	data = static_cast<const unsigned char*>(mapped);
+#endif
+	header = reinterpret_cast<const CorpusHeader*>(data);
+	if (length < sizeof(CorpusHeader) ||
+			memcmp(header->magic, CORPUS_MAGIC, 8) != 0) {
+		error_message = std::string(path) + " is not a maze corpus";
+		close();
+		return false;
+	}
+	if (header->version != CORPUS_VERSION) {
+		error_message = std::string(path) + " has an unsupported version";
+		close();
+		return false;
+	}
+	if (header->index % 8 != 0 || header->index > length ||
+			header->count > (length - header->index) / sizeof(uint64_t)) {
+		error_message = std::string(path) + " is truncated";
+		close();
+		return false;
+	}
+	count = header->count;
+	index = reinterpret_cast<const uint64_t*>(data + header->index);
+	return true;
+}
+
+void Corpus::close() {
+#ifdef WINDOWS
+	buffer.clear();
+#else
+	if (data != nullptr) {
+		munmap(const_cast<unsigned char*>(data), length);
+	}
+#endif
+	data = nullptr;
+	index = nullptr;
+	length = 0;
+	count = 0;
+}
+
+Maze *Corpus::at(uint64_t i) {
+	const CorpusRecord *record;
+	uint64_t offset;
+	if (i >= count) {
+		error_message = "Maze index out of range";
+		return nullptr;
+	}
+	offset = index[i];
+	if (offset % 8 != 0 || offset > length ||
+			length - offset < sizeof(CorpusRecord)) {
+		error_message = "Broken maze record";
+		return nullptr;
+	}
+	record = reinterpret_cast<const CorpusRecord*>(data + offset);
+	if (record->width == 0 || record->height == 0 ||
+			static_cast<uint64_t>(record->width) * record->height > INT_MAX ||
+			length - offset - sizeof(CorpusRecord) <
+			packed_size(record->width, record->height) ||
+			(record->method != 'd' && record->method != 'k' &&
+			record->method != 'p') ||
+			!closed_borders(data + offset + sizeof(CorpusRecord),
+				record->width, record->height)) {
+		error_message = "Broken maze record";
+		return nullptr;
+	}
+	return new Maze(record->width, record->height, record->method,
+			record->seed, data + offset + sizeof(CorpusRecord));
+}
@@ -0,0 +1,63 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "environment/distance.hpp"
+
+void DistanceField::compute(Environment &env, uint32_t source) {
+	uint32_t n = env.width() * env.height(), h = env.height(), head = 0;
+	uint32_t cell, d;
+	char open;
+	dist.assign(n, UINT32_MAX);
+	order.resize(n);
+	first.clear();
+	order[0] = source;
+	dist[source] = 0;
+	n = 1; // from here on, number of queued nodes
+	while (head < n) {
+		cell = order[head];
+		d = dist[cell];
+		if (d == first.size()) { first.push_back(head); }
+		head++;
+		open = env.node(cell);
+		if ((open & 0x01) && dist[cell - 1] == UINT32_MAX) {
+			dist[cell - 1] = d + 1;
+			order[n++] = cell - 1;
+		}
+		if ((open & 0x02) && dist[cell + h] == UINT32_MAX) {
+			dist[cell + h] = d + 1;
+			order[n++] = cell + h;
+		}
+		if ((open & 0x04) && dist[cell + 1] == UINT32_MAX) {
+			dist[cell + 1] = d + 1;
+			order[n++] = cell + 1;
+		}
+		if ((open & 0x08) && dist[cell - h] == UINT32_MAX) {
+			dist[cell - h] = d + 1;
+			order[n++] = cell - h;
+		}
+	}
+	order.resize(n);
+	first.push_back(n);
+}
+
+uint32_t DistanceField::count(uint32_t lo, uint32_t hi) const {
+	if (hi > max_distance()) { hi = max_distance(); }
+	if (lo > hi) { return 0; }
+	return first[hi + 1] - first[lo];
+}
@@ -0,0 +1,129 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "environment/junctions.hpp"
+
+const uint32_t JunctionGraph::NONE;
+
+/** @brief Number of open directions in a bitmask */
+static int degree(char open) {
+	return (open & 0x01) + ((open>>1) & 0x01) + ((open>>2) & 0x01) +
+		((open>>3) & 0x01);
+}
+
+void JunctionGraph::build(Environment &env) {
+	uint32_t i, n = env.width() * env.height(), node;
+	height = env.height();
+	edges.clear();
+	cells.clear();
+	owner.assign(n, NONE);
+	offset.assign(n, 0);
+	toward_b.assign(n, 0);
+	for (i = 0; i < n; i++) {
+		if (degree(env.node(i)) != 2) { add(i); }
+	}
+	links.assign(cells.size() * 4, NONE);
+	for (node = 0; node < cells.size(); node++) {
+		connect(env, node);
+	}
+	// Corridors that form a loop without any junction can't be reached from a
+	// graph node. One of their nodes becomes a graph node then. Perfect mazes
+	// never have those.
+	for (i = 0; i < n; i++) {
+		if (owner[i] == NONE) {
+			add(i);
+			links.resize(cells.size() * 4, NONE);
+			connect(env, cells.size() - 1);
+		}
+	}
+}
+
+void JunctionGraph::add(uint32_t cell) {
+	owner[cell] = cells.size();
+	offset[cell] = NONE;
+	cells.push_back(cell);
+}
+
+void JunctionGraph::connect(Environment &env, uint32_t node) {
+	char dir, open = env.node(cells[node]);
+	for (dir = 0; dir < 4; dir++) {
+		if ((open & (1<<dir)) && links[node * 4 + dir] == NONE) {
+			trace(env, node, dir);
+		}
+	}
+}
+
+void JunctionGraph::trace(Environment &env, uint32_t a, char dir) {
+	Edge e;
+	uint32_t cell = step(cells[a], dir), length = 1, id = edges.size();
+	char open, back = dir^2;
+	e.a = a;
+	e.leave_a = dir;
+	links[a * 4 + dir] = id;
+	while (offset[cell] != NONE) {
+		owner[cell] = id;
+		offset[cell] = length;
+		// continue through the only other open direction
+		open = env.node(cell) & ~(1<<back);
+		for (dir = 0; !(open & (1<<dir)); dir++) {}
+		toward_b[cell] = dir;
+		back = dir^2;
+		cell = step(cell, dir);
+		length++;
+	}
+	e.b = owner[cell];
+	e.length = length;
+	links[e.b * 4 + back] = id;
+	edges.push_back(e);
+}
+
+uint32_t JunctionGraph::run(uint32_t from, char dir, uint32_t stop,
+		uint32_t &to) {
+	uint32_t id, at, end, goal;
+	bool forward;
+	const Edge *e;
+	if (offset[from] == NONE) {
+		// graph node, leave through one of its edges
+		id = links[owner[from] * 4 + dir];
+		if (id == NONE) {
+			to = from;
+			return 0;
+		}
+		e = &edges[id];
+		forward = e->a == owner[from] && e->leave_a == dir;
+		at = forward ? 0 : e->length;
+	}
+	else {
+		// corridor node, go on towards one of the edge ends
+		id = owner[from];
+		e = &edges[id];
+		at = offset[from];
+		forward = toward_b[from] == dir;
+	}
+	end = forward ? e->length : 0;
+	goal = cells[forward ? e->b : e->a];
+	// stop early, if the stop node lies on the way
+	if (stop != NONE && offset[stop] != NONE && owner[stop] == id &&
+			(forward ? offset[stop] > at : offset[stop] < at)) {
+		end = offset[stop];
+		goal = stop;
+	}
+	to = goal;
+	return forward ? end - at : at - end;
+}
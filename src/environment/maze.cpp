@@ -20,38 +20,66 @@
 #include <iostream>
 #include "environment/maze.hpp"
 
-Maze::Maze(int w, int h, char method) {
+Maze::Maze(int w, int h, char method) : Maze(w, h, method, Random::entropy()) {
+}
+
+Maze::Maze(int w, int h, char method, uint64_t seed) : rng(seed) {
    	_width = w; _height = h; x = w/2; y = h/2;
-	int i, n = w * h;
-	// create map vector
-	map.reserve(n);
-	for (i = 0; i < n; i++) {
-		map.push_back(0);
-	}
-	srand(time(NULL));
+	// create map vector, with 4 nodes per byte
+	map.assign((w * h + 3) / 4, 0);
 	switch (method) {
-		case 'd': depth_first(x,  y); break;
+		case 'd': depth_first(w/2, h/2); break;
 		case 'k': kruskal(); break;
 		case 'p': prim(); break;
 	}
-	// Take out all extra information, before continuing.
-	for (i = 0; i < n; i++) {
-		map[i] &= 0x0f;
-	}
+	// Reward placements get a stream of their own, so they don't depend on
+	// how many numbers generation took.
+	rng.seed(seed ^ REWARD_STREAM);
+	topology = std::make_shared<Topology>(w, h, method, seed, std::move(map));
+	view = topology->packed();
+	reset(true);
+}
+
+Maze::Maze(int w, int h, char method, uint64_t seed,
+		const unsigned char *packed) : rng(seed ^ REWARD_STREAM) {
+   	_width = w; _height = h; x = w/2; y = h/2;
+	topology = std::make_shared<Topology>(w, h, method, seed, packed);
+	view = topology->packed();
+	reset(true);
+}
+
+Maze::Maze(std::shared_ptr<const Topology> t) :
+		rng(t->seed() ^ REWARD_STREAM) {
+	_width = t->width(); _height = t->height(); x = _width/2; y = _height/2;
+	view = t->packed();
+	topology = t;
 	reset(true);
 }
 
-unsigned short Maze::reset(bool with_reward) {
-	if (with_reward) {
-		reward_x = std::rand() % _width;
-		reward_y = std::rand() % _height;
+uint64_t Maze::reset(bool with_reward) {
+	uint32_t lo = band_lo, hi = band_hi, cells = _width * _height, cell;
+	uint32_t start = (_width / 2) * _height + _height / 2;
+	if (with_reward && lo == 1 && hi >= cells - 1) {
+		// Every node but start is in the default band of a perfect maze, so
+		// no distances are needed.
+		cell = rng.below(cells - 1);
+		if (cells > 1 && cell >= start) { cell++; }
+		reward_x = cell / _height;
+		reward_y = cell % _height;
+	}
+	else if (with_reward) {
+		const DistanceField &from_start = topology->distances(*this);
+		if (lo > from_start.max_distance()) { lo = from_start.max_distance(); }
+		cell = from_start.pick(lo, rng.below(from_start.count(lo, hi)));
+		reward_x = cell / _height;
+		reward_y = cell % _height;
 	}
 	x = _width / 2;
 	y = _height / 2;
-	return (x<<8)|y;
+	return state();
 }
 
-unsigned short Maze::act(unsigned char action) {
+uint64_t Maze::act(unsigned char action) {
 	// test if action is valid
 	unsigned char do_action = valid_actions() & action;
 	switch (do_action) {
@@ -62,118 +90,190 @@ unsigned short Maze::act(unsigned char action) {
 		case 0x0008: x--; break; // move left one step
 		default: break; // all other actions are invalid
 	}
-	return (x<<8)|y;
+	return state();
 }
 
 unsigned char Maze::valid_actions() {
 	return (map_get(x, y) & 0x0f);
 }
 
-void Maze::depth_first(int cx, int cy) {
-	// set node visited
-	int nx = cx, ny = cy, i, r;
-	std::vector<char> dirs;
-	map_set(cx, cy, 0x30); // set current value visited
-	dirs.reserve(4);
-	// test if nodes around can be visited
-	for (i = 0; i < 4; i++) {
-		dirs.push_back(i);
+uint32_t Maze::run(unsigned char action) {
+	uint32_t to, steps;
+	char dir;
+	switch (valid_actions() & action) {
+		case 0x0001: dir = 0; break;
+		case 0x0002: dir = 1; break;
+		case 0x0004: dir = 2; break;
+		case 0x0008: dir = 3; break;
+		default: return 0; // invalid or more than one action
 	}
-	// improve randomization
-	for (i = 0; i < 10; i++) {
-		std::random_shuffle(dirs.begin(), dirs.end());
+	steps = junctions().run(x * _height + y, dir,
+			reward_x * _height + reward_y, to);
+	x = to / _height;
+	y = to % _height;
+	return steps;
+}
+
+MazeState Maze::snapshot() {
+	MazeState s;
+	s.x = x;
+	s.y = y;
+	s.reward_x = reward_x;
+	s.reward_y = reward_y;
+	s.rng = rng;
+	return s;
+}
+
+void Maze::restore(const MazeState &s) {
+	x = s.x;
+	y = s.y;
+	reward_x = s.reward_x;
+	reward_y = s.reward_y;
+	rng = s.rng;
+}
+
+JunctionGraph &Maze::junctions() {
+	if (!graph) {
+		graph = std::make_shared<JunctionGraph>();
+		graph->build(*this);
 	}
-	// walk over all possible node directions and see if we can progress on any
-	while (!dirs.empty()) {
-		nx = cx; ny = cy; // Reset values, so stuff works.
-		r = dirs.back();
-		dirs.pop_back(); // remove last value, after fetching it
-		switch (r) {
-			case 0: ny = cy - 1; break;
-			case 1: nx = cx + 1; break;
-			case 2: ny = cy + 1; break;
-			case 3: nx = cx - 1; break;
+	return *graph;
+}
+
+void Maze::depth_first(int cx, int cy) {
+	int start = cx * _height + cy, cell = start, next, size;
+	char dir, open[4];
+	// The backtracking stack lives inside a single scratch byte per cell.
+	// Visited cells are marked with 0x10 and remember the direction back to
+	// their parent in the two lower bits, so no matter the maze size, there
+	// is no other memory needed.
+	std::vector<unsigned char> flags(_width * _height, 0);
+	flags[cell] = 0x10;
+	while (true) {
+		size = 0;
+		for (dir = 0; dir < 4; dir++) {
+			if ((next = neighbor(cell, dir)) >= 0 && !flags[next]) {
+				open[size++] = dir;
+			}
+		}
+		if (size > 0) {
+			dir = open[rng.below(size)];
+			next = neighbor(cell, dir);
+			carve(cell, dir);
+			flags[next] = 0x10 | (dir^2);
+			cell = next;
 		}
-		if (ny >= 0 && ny < _height && nx >= 0 && nx < _width &&
-			   	!(map_get(nx, ny) & 0x30)) {
-			map_set(cx, cy, 1<<r);
-			map_set(nx, ny, (0x30 | 1<<(r^2)));
-			depth_first(nx, ny);
+		else if (cell != start) {
+			// dead end, walk back to parent
+			cell = neighbor(cell, flags[cell] & 0x03);
 		}
+		else {
+			break;
+		}
+	}
+}
+
+/** @brief Find representative of a disjoint set
+ *
+ * Sets are stored as parent links, where a root holds its negated set size.
+ * Every node visited on the way up gets linked to the root directly (path
+ * compression), so following lookups are nearly constant.
+ *
+ * @param[in] vector<int> sets - Parent links of all cells
+ * @param[in] int i - Cell index to look up
+ *
+ * @return int index of the root cell
+ */
+static int find_set(std::vector<int> &sets, int i) {
+	int root = i, next;
+	while (sets[root] >= 0) { root = sets[root]; }
+	while (sets[i] >= 0) {
+		next = sets[i];
+		sets[i] = root;
+		i = next;
 	}
+	return root;
 }
 
 void Maze::kruskal() {
-	int i, u, n = _width * _height, wall, wx, wy, vx, vy, cell;
-	char dir;
-	std::vector<int> cells, walls;
-	cells.reserve(n);
-	walls.reserve(n*4);
-	for (i = 0; i < n*4; i++) {
-		if (i % 4 == 0) { cells.push_back(i / 4); }
-		walls.push_back(i);
+	int i, n = _width * _height, joined = 0, wall, cell, next, a, b;
+	std::vector<int> sets(n, -1), walls;
+	// Only east and south walls are stored, as every inner wall is shared by
+	// two cells. Border walls are left out completely.
+	walls.reserve((_width - 1) * _height + _width * (_height - 1));
+	for (i = 0; i < n; i++) {
+		if (i / _height < _width - 1) { walls.push_back(i * 2); }
+		if (i % _height < _height - 1) { walls.push_back(i * 2 + 1); }
 	}
-	std::random_shuffle(walls.begin(), walls.end());
-	for (i = 0; i < n*4; i++) {
+	rng.shuffle(walls.begin(), walls.end());
+	for (i = 0; i < static_cast<int>(walls.size()) && joined < n - 1; i++) {
 		wall = walls[i];
-		wy = (wall / 4) % _height;
-		wx = (wall / 4) / _height;
-		vy = wy; vx = wx;
-		dir = wall % 4;
-		switch (dir) {
-			case 0: vy = wy - 1; break;
-			case 1: vx = wx + 1; break;
-			case 2: vy = wy + 1; break;
-			case 3: vx = wx - 1; break;
-		}
-		if (vy >= 0 && vy < _height && vx >= 0 && vx < _width) {
-			if (cells[wx * _height + wy] != cells[vx * _height + vy]) {
-				cell = cells[vx * _height + vy];
-				map_set(wx, wy, 1<<dir);
-				map_set(vx, vy, 1<<(dir^2));
-				for (u = 0; u < n; u++) {
-					if (cells[u] == cell) {
-						cells[u] = cells[wx * _height + wy];
-					}
-				}
-			}
+		cell = wall / 2;
+		next = (wall & 1) ? cell + 1 : cell + _height;
+		a = find_set(sets, cell);
+		b = find_set(sets, next);
+		if (a != b) {
+			// union by size, smaller tree gets attached to bigger one
+			if (sets[a] > sets[b]) { std::swap(a, b); }
+			sets[a] += sets[b];
+			sets[b] = a;
+			carve(cell, (wall & 1) ? 2 : 1);
+			joined++;
 		}
 	}
 }
 
 void Maze::prim() {
-	int i, wall, wx = x, wy = y, vx, vy;
+	int r, wall, cell, next, cx = _width / 2, cy = _height / 2;
 	char dir;
 	std::vector<int> walls;
-	walls.reserve(_width * _height * 4);
-	map_set(wx, wy, 0x10);
-	for (i = 0; i < 4; i++) {
-		walls.push_back((wx * _height + wy) * 4 + i);
+	// Cells of the maze are marked with 0x10. Walls are stored as
+	// cell * 4 + direction and only added towards cells outside of the maze,
+	// so every wall enters the list at most once.
+	std::vector<unsigned char> flags(_width * _height, 0);
+	walls.reserve(2 * _width * _height);
+	cell = cx * _height + cy;
+	flags[cell] = 0x10;
+	for (dir = 0; dir < 4; dir++) {
+		if (neighbor(cell, dir) >= 0) { walls.push_back(cell * 4 + dir); }
 	}
-	do {
-		std::random_shuffle(walls.begin(), walls.end());
-		wall = walls.back();
-		walls.pop_back(); // remove last value, after fetching it
-		wy = (wall / 4) % _height;
-		wx = (wall / 4) / _height;
-		vy = wy; vx = wx;
-		dir = wall % 4;
-		switch (dir) {
-			case 0: vy = wy - 1; break;
-			case 1: vx = wx + 1; break;
-			case 2: vy = wy + 1; break;
-			case 3: vx = wx - 1; break;
-		}
-		if (vy >= 0 && vy < _height && vx >= 0 && vx < _width) {
-			if (!(map_get(vx, vy)&0x10)) {
-				map_set(wx, wy, 1<<dir);
-				map_set(vx, vy, 1<<(dir^2));
-				map_set(vx, vy, 0x10);
-				for (i = 0; i < 4; i++) {
-					walls.push_back((vx * _height + vy) * 4 + i);
-				}
+	while (!walls.empty()) {
+		// pick a random wall and fill its slot with the last one
+		r = rng.below(walls.size());
+		wall = walls[r];
+		walls[r] = walls.back();
+		walls.pop_back();
+		cell = wall >> 2;
+		next = neighbor(cell, wall & 3);
+		// walls to cells, that joined the maze meanwhile, are dropped
+		if (flags[next]) { continue; }
+		carve(cell, wall & 3);
+		flags[next] = 0x10;
+		for (dir = 0; dir < 4; dir++) {
+			if ((r = neighbor(next, dir)) >= 0 && !flags[r]) {
+				walls.push_back(next * 4 + dir);
 			}
 		}
-		
-	} while (!walls.empty());
+	}
+}
+
+int Maze::neighbor(int cell, char dir) {
+	switch (dir) {
+		case 0: return (cell % _height > 0) ? cell - 1 : -1;
+		case 1: return (cell / _height < _width - 1) ? cell + _height : -1;
+		case 2: return (cell % _height < _height - 1) ? cell + 1 : -1;
+		case 3: return (cell / _height > 0) ? cell - _height : -1;
+	}
+	return -1;
+}
+
+void Maze::carve(int cell, char dir) {
+	// only east and south passages are stored, so walls to the north and west
+	// are opened from the neighbor's side
+	switch (dir) {
+		case 0: open(cell - 1, 0x02); break;
+		case 1: open(cell, 0x01); break;
+		case 2: open(cell, 0x02); break;
+		case 3: open(cell - _height, 0x01); break;
+	}
 }
@@ -0,0 +1,97 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "environment/maze.hpp"
+#include "environment/maze_batch.hpp"
+
+MazeBatch::MazeBatch(unsigned int n, int w, int h, char method,
+		uint64_t seed) : n(n), _width(w), _height(h), method(method), rng(seed) {
+	unsigned int i, cells = w * h;
+	stride = (cells + 1) / 2;
+	start = (w/2) * h + h/2;
+	// Only single actions move, everything else is invalid (like Maze::act)
+	for (i = 0; i < 16; i++) { moves[i] = 0; }
+	moves[0x01] = -1;
+	moves[0x02] = h;
+	moves[0x04] = 1;
+	moves[0x08] = -h;
+	maps.assign(static_cast<size_t>(n) * stride, 0);
+	positions.assign(n, start);
+	rewards_at.resize(n);
+	seeds.resize(n);
+	placements.resize(n);
+	for (i = 0; i < n; i++) {
+		regenerate(i);
+	}
+}
+
+void MazeBatch::regenerate(unsigned int i) {
+	unsigned int c, cells = _width * _height;
+	seeds[i] = rng();
+	Maze maze(_width, _height, method, seeds[i]);
+	std::vector<char> nodes = maze.nodes();
+	uint8_t *m = &maps[static_cast<size_t>(i) * stride];
+	std::fill(m, m + stride, 0);
+	for (c = 0; c < cells; c++) {
+		m[c>>1] |= nodes[c] << ((c&1)<<2);
+	}
+	positions[i] = start;
+	placements[i].seed(seeds[i] ^ Maze::REWARD_STREAM);
+	rewards_at[i] = place(i);
+}
+
+void MazeBatch::reset(uint32_t *states) {
+	unsigned int i;
+	for (i = 0; i < n; i++) {
+		positions[i] = start;
+		rewards_at[i] = place(i);
+		states[i] = start;
+	}
+}
+
+void MazeBatch::step(const uint8_t *actions, uint32_t *states, float *rewards,
+		uint8_t *done) {
+	unsigned int i;
+	uint32_t pos;
+	for (i = 0; i < n; i++) {
+		pos = positions[i];
+		pos += moves[actions[i] & node(i, pos)];
+		if (pos == rewards_at[i]) {
+			rewards[i] = 100;
+			done[i] = 1;
+			pos = start;
+			rewards_at[i] = place(i);
+		}
+		else {
+			rewards[i] = 0;
+			done[i] = 0;
+		}
+		positions[i] = pos;
+		states[i] = pos;
+	}
+}
+
+void MazeBatch::valid_actions(uint8_t *masks) {
+	unsigned int i;
+	for (i = 0; i < n; i++) {
+		masks[i] = node(i, positions[i]);
+	}
+}
@@ -0,0 +1,95 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "environment/maze_pool.hpp"
+
+const char MazePool::methods[3] = {'k', 'd', 'p'};
+
+MazePool::MazePool(int w, int h, uint64_t seed) : width(w), height(h),
+		stopping(false) {
+	int i;
+	Random seeder(seed);
+	for (i = 0; i < 3; i++) { rng[i].seed(seeder()); }
+	producer = std::thread(&MazePool::produce, this);
+}
+
+MazePool::~MazePool() {
+	Maze *maze;
+	int i;
+	mtx.lock();
+	stopping = true;
+	mtx.unlock();
+	taken.notify_one();
+	producer.join();
+	for (i = 0; i < 3; i++) {
+		while (ready[i].pop(maze)) { delete maze; }
+	}
+}
+
+Maze *MazePool::take(char method) {
+	Maze *maze;
+	int i = slot(method);
+	if (i < 0) { return new Maze(width, height, method); }
+	if (!ready[i].pop(maze)) {
+		// Nothing ready yet. Wait for the producer, instead of generating a
+		// maze here, so seeded runs always get the same mazes.
+		std::unique_lock<std::mutex> lock(mtx);
+		produced.wait(lock, [this, i, &maze]{ return ready[i].pop(maze); });
+	}
+	{
+		// lock, so the producer can't miss this notification
+		std::lock_guard<std::mutex> lock(mtx);
+	}
+	taken.notify_one();
+	return maze;
+}
+
+void MazePool::produce() {
+	int i;
+	bool idle;
+	while (!stopping) {
+		idle = true;
+		for (i = 0; i < 3 && !stopping; i++) {
+			if (!ready[i].full()) {
+				ready[i].push(new Maze(width, height, methods[i], rng[i]()));
+				{
+					std::lock_guard<std::mutex> lock(mtx);
+				}
+				produced.notify_one();
+				idle = false;
+			}
+		}
+		if (idle) {
+			std::unique_lock<std::mutex> lock(mtx);
+			taken.wait(lock, [this]{
+				return stopping || ready[0].full() + ready[1].full() +
+					ready[2].full() < 3;
+			});
+		}
+	}
+}
+
+int MazePool::slot(char method) {
+	switch (method) {
+		case 'k': return 0;
+		case 'd': return 1;
+		case 'p': return 2;
+	}
+	return -1;
+}
@@ -0,0 +1,153 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if defined(__linux__)
+	#include <pthread.h>
+	#include <sched.h>
+#endif
+
+#include "environment/runner.hpp"
+
+Runner::Runner(unsigned int shards, unsigned int n, int w, int h, char method,
+		uint64_t seed, unsigned int threads, bool pin) : per_shard(n),
+		pending(0) {
+	unsigned int i;
+	Random rng(seed);
+	// hardware_concurrency() is 0, if it can't be detected
+	cores = std::thread::hardware_concurrency();
+	if (cores == 0) { cores = 1; }
+	if (threads == 0) { threads = cores; }
+	batches.reserve(shards);
+	for (i = 0; i < shards; i++) {
+		batches.emplace_back(n, w, h, method, rng());
+	}
+	for (i = 0; i < threads; i++) {
+		queues.emplace_back(new Queue());
+	}
+	for (i = 0; i < threads; i++) {
+		pool.emplace_back(&Runner::work, this, i, pin);
+	}
+}
+
+Runner::~Runner() {
+	mtx.lock();
+	stopping = true;
+	mtx.unlock();
+	wake.notify_all();
+	for (std::thread &t : pool) {
+		t.join();
+	}
+}
+
+void Runner::reset(uint32_t *states) {
+	unsigned int i;
+	for (i = 0; i < batches.size(); i++) {
+		batches[i].reset(states + i * per_shard);
+	}
+}
+
+void Runner::step(const uint8_t *actions, uint32_t *states, float *rewards,
+		uint8_t *done, uint8_t *observations) {
+	unsigned int i;
+	std::unique_lock<std::mutex> lock(mtx);
+	this->actions = actions;
+	this->states = states;
+	this->rewards = rewards;
+	this->done = done;
+	this->observations = observations;
+	pending = batches.size();
+	for (i = 0; i < batches.size(); i++) {
+		std::lock_guard<std::mutex> guard(queues[i % queues.size()]->lock);
+		queues[i % queues.size()]->shards.push_back(i);
+	}
+	generation++;
+	wake.notify_all();
+	finished.wait(lock, [this]{ return pending == 0; });
+}
+
+void Runner::work(unsigned int id, bool pin) {
+	unsigned long seen = 0;
+	unsigned int shard;
+#if defined(__linux__)
+	if (pin) {
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(id % cores, &set);
+		pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+	}
+#else
+	(void)pin;
+#endif
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(mtx);
+			wake.wait(lock, [this, seen]{ return stopping || generation != seen; });
+			if (stopping) { return; }
+			seen = generation;
+		}
+		while (next(id, shard)) {
+			run(shard);
+			if (--pending == 0) {
+				// lock, so step() can't miss this notification
+				std::lock_guard<std::mutex> lock(mtx);
+				finished.notify_one();
+			}
+		}
+	}
+}
+
+bool Runner::next(unsigned int id, unsigned int &shard) {
+	unsigned int i;
+	Queue *q;
+	// own queue first, newest shard
+	{
+		std::lock_guard<std::mutex> lock(queues[id]->lock);
+		if (!queues[id]->shards.empty()) {
+			shard = queues[id]->shards.back();
+			queues[id]->shards.pop_back();
+			return true;
+		}
+	}
+	// steal oldest shard of another worker
+	for (i = 1; i < queues.size(); i++) {
+		q = queues[(id + i) % queues.size()].get();
+		std::lock_guard<std::mutex> lock(q->lock);
+		if (!q->shards.empty()) {
+			shard = q->shards.front();
+			q->shards.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+void Runner::run(unsigned int shard) {
+	unsigned int i, offset = shard * per_shard;
+	MazeBatch &batch = batches[shard];
+	batch.step(actions + offset, states + offset, rewards + offset,
+			done + offset);
+	if (regenerate_done) {
+		for (i = 0; i < per_shard; i++) {
+			if (done[offset + i]) { batch.regenerate(i); }
+		}
+	}
+	if (observations != nullptr) {
+		batch.valid_actions(observations + offset);
+	}
+}
@@ -0,0 +1,270 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "environment/solver.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	#include <immintrin.h>
+	#define SOLVER_AVX2
+#endif
+
+/** @brief Pointers to all boards, used by one expansion step */
+struct Boards {
+	const uint64_t *e, *s, *f;
+	uint64_t *n, *v, *b0, *b1, *b2, *b3;
+	size_t w;
+};
+
+/** @brief Expand the frontier over words [i, end)
+ *
+ * New nodes are checked in a fixed direction order, so every node gets exactly
+ * one parent.
+ *
+ * @return uint64_t non-zero if any new node was found
+ */
+static uint64_t expand(const Boards &b, size_t i, size_t end) {
+	uint64_t f, v, r, l, d, u, any = 0;
+	for (; i < end; i++) {
+		f = b.f[i];
+		v = b.v[i];
+		r = ((f & b.e[i]) << 1) | ((b.f[i-1] & b.e[i-1]) >> 63);
+		l = ((f >> 1) | (b.f[i+1] << 63)) & b.e[i];
+		d = b.f[i - b.w] & b.s[i - b.w];
+		u = b.f[i + b.w] & b.s[i];
+		r &= ~v; v |= r;
+		l &= ~v; v |= l;
+		d &= ~v; v |= d;
+		u &= ~v; v |= u;
+		b.b3[i] |= r;
+		b.b1[i] |= l;
+		b.b0[i] |= d;
+		b.b2[i] |= u;
+		b.n[i] = r | l | d | u;
+		b.v[i] = v;
+		any |= b.n[i];
+	}
+	return any;
+}
+
+#ifdef SOLVER_AVX2
+/** @brief AVX2 version of expand(), for 4 words at a time
+ *
+ * Neighboring words are fetched with unaligned loads, one word off, so the
+ * carry between words comes for free.
+ */
+__attribute__((target("avx2")))
+static uint64_t expand_avx2(const Boards &b, size_t i, size_t end) {
+	__m256i f, v, r, l, d, u, n, any = _mm256_setzero_si256();
+	uint64_t rest[4];
+#define LOAD(p) _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))
+#define STORE(p, x) _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), x)
+	for (; i + 4 <= end; i += 4) {
+		f = LOAD(b.f + i);
+		v = LOAD(b.v + i);
+		r = _mm256_or_si256(
+				_mm256_slli_epi64(_mm256_and_si256(f, LOAD(b.e + i)), 1),
+				_mm256_srli_epi64(_mm256_and_si256(LOAD(b.f + i - 1),
+						LOAD(b.e + i - 1)), 63));
+		l = _mm256_and_si256(_mm256_or_si256(_mm256_srli_epi64(f, 1),
+					_mm256_slli_epi64(LOAD(b.f + i + 1), 63)), LOAD(b.e + i));
+		d = _mm256_and_si256(LOAD(b.f + i - b.w), LOAD(b.s + i - b.w));
+		u = _mm256_and_si256(LOAD(b.f + i + b.w), LOAD(b.s + i));
+		r = _mm256_andnot_si256(v, r); v = _mm256_or_si256(v, r);
+		l = _mm256_andnot_si256(v, l); v = _mm256_or_si256(v, l);
+		d = _mm256_andnot_si256(v, d); v = _mm256_or_si256(v, d);
+		u = _mm256_andnot_si256(v, u); v = _mm256_or_si256(v, u);
+		STORE(b.b3 + i, _mm256_or_si256(LOAD(b.b3 + i), r));
+		STORE(b.b1 + i, _mm256_or_si256(LOAD(b.b1 + i), l));
+		STORE(b.b0 + i, _mm256_or_si256(LOAD(b.b0 + i), d));
+		STORE(b.b2 + i, _mm256_or_si256(LOAD(b.b2 + i), u));
+		n = _mm256_or_si256(_mm256_or_si256(r, l), _mm256_or_si256(d, u));
+		STORE(b.n + i, n);
+		STORE(b.v + i, v);
+		any = _mm256_or_si256(any, n);
+	}
+#undef LOAD
+#undef STORE
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(rest), any);
+	return rest[0] | rest[1] | rest[2] | rest[3] | expand(b, i, end);
+}
+#endif
+
+/** @brief Expand a narrow frontier node by node
+ *
+ * Parents go to the same boards as with expand(), so steps of both kinds can
+ * be mixed within one search.
+ *
+ * @param[in] const Boards& b - Boards, only e, s, v and b0 to b3 are used
+ * @param[in] vector<size_t>& from - Bit positions of the frontier
+ * @param[out] vector<size_t>& to - Bit positions of newly found nodes
+ */
+static void expand_nodes(const Boards &b, const std::vector<size_t> &from,
+		std::vector<size_t> &to) {
+	size_t row = b.w * 64, n;
+	to.clear();
+#define OPEN(board, p) ((board[(p)>>6] >> ((p)&63)) & 1)
+#define VISIT(p, back) if (!OPEN(b.v, p)) { \
+		b.v[(p)>>6] |= 1ULL << ((p)&63); \
+		back[(p)>>6] |= 1ULL << ((p)&63); \
+		to.push_back(p); \
+	}
+	for (size_t p : from) {
+		n = p + 1;
+		if (OPEN(b.e, p)) { VISIT(n, b.b3) }
+		n = p - 1;
+		if (OPEN(b.e, n)) { VISIT(n, b.b1) }
+		n = p + row;
+		if (OPEN(b.s, p)) { VISIT(n, b.b0) }
+		n = p - row;
+		if (OPEN(b.s, n)) { VISIT(n, b.b2) }
+	}
+#undef VISIT
+#undef OPEN
+}
+
+void Solver::load(Environment &env) {
+	const unsigned char *packed = env.packed();
+	uint32_t i, n;
+	unsigned char p;
+	size_t at;
+	width = env.width();
+	height = env.height();
+	n = width * height;
+	words = (width + 63) / 64;
+	// one zero row plus one word on each side, so neighbors of border words
+	// can be read without checks
+	pad = words + 1;
+	east.assign(words * height + 2 * pad, 0);
+	south.assign(east.size(), 0);
+	for (i = 0; i < n; i++) {
+		p = (packed[i>>2] >> ((i&3)<<1)) & 0x03;
+		if (p) {
+			at = bit(i);
+			if (p & 0x01) { east[at>>6] |= 1ULL << (at&63); }
+			if (p & 0x02) { south[at>>6] |= 1ULL << (at&63); }
+		}
+	}
+}
+
+uint32_t Solver::solve(uint32_t source, uint32_t target,
+		std::vector<unsigned char> *path) {
+	size_t size = east.size(), lo, hi, plo, phi, at, to = bit(target), i, nodes;
+	uint32_t steps = 0, cell;
+	int d;
+	bool sweep = false;
+	Boards b;
+	uint64_t (*step)(const Boards&, size_t, size_t) = expand;
+#ifdef SOLVER_AVX2
+	if (__builtin_cpu_supports("avx2")) { step = expand_avx2; }
+#endif
+	frontier.assign(size, 0);
+	next.assign(size, 0);
+	visited.assign(size, 0);
+	for (d = 0; d < 4; d++) { back[d].assign(size, 0); }
+	at = bit(source);
+	visited[at>>6] |= 1ULL << (at&63);
+	queued.assign(1, at);
+	lo = hi = plo = phi = 0;
+	b.e = east.data();
+	b.s = south.data();
+	b.f = frontier.data();
+	b.n = next.data();
+	b.v = visited.data();
+	b.b0 = back[0].data();
+	b.b1 = back[1].data();
+	b.b2 = back[2].data();
+	b.b3 = back[3].data();
+	b.w = words;
+	while (!test(visited, to)) {
+		if (!sweep) {
+			expand_nodes(b, queued, ahead);
+			if (ahead.empty()) { return UINT32_MAX; }
+			steps++;
+			queued.swap(ahead);
+			// positions grow with rows, so the band is spanned by the extremes
+			lo = (*std::min_element(queued.begin(), queued.end()) / 64 - pad) /
+				words;
+			hi = (*std::max_element(queued.begin(), queued.end()) / 64 - pad) /
+				words;
+			if (queued.size() * SPARSE >= (hi - lo + 3) * words + SWEEP) {
+				for (size_t p : queued) { frontier[p>>6] |= 1ULL << (p&63); }
+				plo = lo;
+				phi = hi;
+				sweep = true;
+			}
+			continue;
+		}
+		// clear rows of next, left over from two steps ago
+		std::fill(next.begin() + pad + plo * words,
+				next.begin() + pad + (phi + 1) * words, 0);
+		plo = lo > 0 ? lo - 1 : 0;
+		phi = std::min(hi + 1, static_cast<size_t>(height - 1));
+		b.f = frontier.data();
+		b.n = next.data();
+		if (!step(b, pad + plo * words, pad + (phi + 1) * words)) {
+			return UINT32_MAX;
+		}
+		steps++;
+		frontier.swap(next);
+		// shrink to rows, that actually hold new nodes, and count those
+		lo = phi + 1;
+		nodes = 0;
+		for (i = pad + plo * words; i < pad + (phi + 1) * words; i++) {
+			if (frontier[i]) {
+				nodes += __builtin_popcountll(frontier[i]);
+				hi = (i - pad) / words;
+				if (lo > phi) { lo = hi; }
+			}
+		}
+		// a frontier this thin is cheaper to follow node by node, which is
+		// what happens along the long corridors of depth-first mazes
+		if (nodes * SPARSE * 2 < (hi - lo + 3) * words + SWEEP) {
+			queued.clear();
+			for (i = pad + lo * words; i < pad + (hi + 1) * words; i++) {
+				for (uint64_t w = frontier[i]; w; w &= w - 1) {
+					queued.push_back(i * 64 + __builtin_ctzll(w));
+				}
+			}
+			std::fill(frontier.begin() + pad + plo * words,
+					frontier.begin() + pad + (phi + 1) * words, 0);
+			std::fill(next.begin() + pad + plo * words,
+					next.begin() + pad + (phi + 1) * words, 0);
+			sweep = false;
+		}
+	}
+	if (path != nullptr) {
+		path->assign(steps, 0);
+		cell = target;
+		while (cell != source) {
+			at = bit(cell);
+			for (d = 0; d < 4 && !test(back[d], at); d++) {}
+			(*path)[--steps] = 1<<(d^2);
+			switch (d) {
+				case 0: cell -= 1; break;
+				case 1: cell += height; break;
+				case 2: cell += 1; break;
+				case 3: cell -= height; break;
+			}
+		}
+		return path->size();
+	}
+	return steps;
+}
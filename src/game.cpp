@@ -0,0 +1,66 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "game.hpp"
+
+Game::Game(Environment *env) : env(env) {
+	// reset everything to standard values
+	pos = env->state();
+	_energy = 300;
+	_time_drain = 1; time_drain_increase = 1; time_drain_counter = 1;
+	_step_drain = 1; step_drain_increase = 1; step_drain_counter = 1;
+	_seconds = 0; _steps = 0; _score = 0;
+}
+
+bool Game::act(unsigned char action) {
+	if (!(env->valid_actions() & action)) { return false; }
+	pos = env->act(action);
+	_energy -= _step_drain;
+	_steps++;
+	if (_steps % DRAIN_STEPS == 0) {
+		if (step_drain_counter++ % 5 == 0) { step_drain_increase *= 2; }
+		_step_drain += step_drain_increase;
+	}
+	if (pos == env->reward_position()) {
+		pos = env->reset(true);
+		_score++;
+		_energy += ENERGY_UP;
+	}
+	clip_energy();
+	return true;
+}
+
+void Game::tick() {
+	_seconds++;
+	_energy -= _time_drain;
+	clip_energy();
+	if (_seconds % DRAIN_INTERVAL == 0) {
+		if (time_drain_counter++ % 5 == 0) { time_drain_increase *= 2; }
+		_time_drain += time_drain_increase;
+	}
+}
+
+void Game::clip_energy() {
+	if (_energy > MAX_ENERGY) {
+		_energy = MAX_ENERGY;
+	}
+	else if (_energy < MIN_ENERGY) {
+		_energy = MIN_ENERGY;
+	}
+}
@@ -18,38 +18,67 @@
  */
 
 #include <unistd.h>
+#include <getopt.h>
 #include <csignal>
+#include <cstdlib>
 #include <cmath>
+#include <cstdio>
+#include <cstring>
 
 #include <iostream>
 #include <thread>
 #include <chrono>
 #include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <map>
+#include <vector>
 
 #include "config.hpp"
 #include "board/curses.hpp"
+#include "board/null.hpp"
+#include "board/recording.hpp"
 #include "environment/maze.hpp"
+#include "environment/maze_pool.hpp"
+#include "environment/corpus.hpp"
+#include "synth/alex.hpp"
+#include "snapshot.hpp"
+#include "game.hpp"
+#include "replay.hpp"
 
 using namespace std;
 
+/** @brief Game state, as seen by renderers and other observers */
+struct GameState {
+	int energy, time_drain, step_drain;
+	unsigned int seconds, steps;
+	unsigned short score;
+	char hint;
+	uint64_t pos, reward;
+};
+
 Board *board = nullptr;
-Environment *env = nullptr;
-bool run;
-mutex mtx;
-int energy;
-int time_drain, step_drain, time_drain_increase, step_drain_increase;
-int time_drain_counter, step_drain_counter;
-unsigned int seconds, steps;
-unsigned short score, pos;
+Maze *env = nullptr;
+Game *game = nullptr;
+MazePool *pool = nullptr;
+Alex alex;
+atomic<bool> run;
+mutex mtx; // serializes writers of game state (input and timer)
+mutex ui_mtx; // only guards waiting for changes
+condition_variable changed; // notified, whenever game state changes
+condition_variable stopped; // notified, when game ends
+Snapshot<GameState> snapshot; // latest game state, read without locks
+Replay replay; // log of current game
+const char *log_path = nullptr; // file to log games to, if any
+bool log_failed = false;
+bool synchronous = false; // draw every state change at once, without UI thread
 char maze = 'k'; // maze generation picker indicator
+bool seeded = false; // true if a seed was given on the command line
+uint64_t seed;
+int maze_width, maze_height;
 
-// These are all game rule definitions and necessary to properly run Amazed
-#define MAX_ENERGY 1000
-#define MIN_ENERGY 0
-#define ENERGY_UP 300
-
-#define DRAIN_INTERVAL 15
-#define DRAIN_STEPS 100
+#define MAZE_WIDTH 38
+#define MAZE_HEIGHT 9
 
 /** @brief Helper cleanup function
  *
@@ -62,10 +91,18 @@ void cleanup(int sig = 0) {
 		delete board;
 		board = nullptr;
 	}
+	if (game != nullptr) {
+		delete game;
+		game = nullptr;
+	}
 	if (env != nullptr) {
 		delete env;
 		env = nullptr;
 	}
+	if (pool != nullptr) {
+		delete pool;
+		pool = nullptr;
+	}
 	if (sig) {
 		exit(1);
 	}
@@ -74,10 +111,38 @@ void cleanup(int sig = 0) {
 /** @brief Helper function to print 'help' information and credits */
 void print_help() {
 	cout << "Usage:" << endl
-		<< "  " << PROGNAME << " [-d] [-k] [-p]" << endl
+		<< "  " << PROGNAME << " [-d] [-k] [-p] [-s seed] [--size WxH]" << endl
 		<< "     -d	Randomized Depth-First search (corridor bias)" << endl
 	   	<< "     -k	Randomized Kruskal's algorithm (dead end bias)" << endl
 	   	<< "     -p	Randomized Prim's algorithm (dead end bias)" << endl
+	   	<< "     -s, --seed N	Seed for maze generation and reward placements"
+		<< endl
+		<< "     --size WxH	Maze size (default " << MAZE_WIDTH << "x"
+		<< MAZE_HEIGHT << "), bigger mazes scroll" << endl
+		<< endl
+		<< "  " << PROGNAME << " --generate N --out FILE [--algo A] [--size WxH]"
+		<< " [--threads N] [-s seed]" << endl
+		<< "     --generate N	Generate N mazes into a corpus, without UI" << endl
+		<< "     --out FILE	Corpus file to write" << endl
+		<< "     --algo A	Algorithm to use (d, k or p)" << endl
+		<< "     --size WxH	Maze size (default " << MAZE_WIDTH << "x"
+		<< MAZE_HEIGHT << ")" << endl
+		<< "     --threads N	Worker threads (default one per core)" << endl
+		<< endl
+		<< "  " << PROGNAME << " --headless KEYS [--record FILE] [-d] [-k] [-p]"
+		<< " [-s seed] [--size WxH]" << endl
+		<< "     --headless KEYS	Play one game without terminal, where KEYS"
+		<< " are moves (u, r, d, l)" << endl
+		<< "     --record FILE	Write all frames of that game to FILE" << endl
+		<< "     --log FILE	Write a replay of the last game to FILE (works"
+		<< " for normal games too)" << endl
+		<< endl
+		<< "  " << PROGNAME << " --replay FILE" << endl
+		<< "     --replay FILE	Simulate a replay again and check its score"
+		<< endl
+		<< "  " << PROGNAME << " --watch FILE [--speed N]" << endl
+		<< "     --watch FILE	Show a replay" << endl
+		<< "     --speed N	Actions per second (default 20)" << endl
 		<< endl
 		<< "To play game, move the cursor with arrow keys." << endl
 		<< "To quit game, press 'q'" << endl
@@ -89,80 +154,188 @@ void print_help() {
 		<< "All Patreon supporters will be mentioned in this help!" << endl;
 }
 
-/** @brief Test if game over state is reached
+/** @brief Headless bulk generation of mazes into a corpus file
+ *
+ * Mazes are generated in chunks, by several worker threads, while this thread
+ * writes finished chunks to the corpus in order. Maze seeds only depend on
+ * the base seed and the maze's position, so a seeded corpus is always the
+ * same, no matter the number of threads.
  *
- * Game over states are reached by the general rule that energy levels reach 0
+ * @param[in] uint64_t count - Number of mazes
+ * @param[in] unsigned int threads - Number of worker threads (0 for one per
+ * core)
+ * @param[in] const char* path - Corpus file to write
  *
+ * @return int exit code
  */
-void test_game_over() {
-	if (energy <= 0) { run = false; }
+int generate(uint64_t count, unsigned int threads, const char *path) {
+	const uint64_t chunk = 256;
+	uint64_t c, chunks = (count + chunk - 1) / chunk, written = 0, window;
+	uint64_t base = seeded ? seed : Random::entropy();
+	std::atomic<uint64_t> next(0);
+	std::map<uint64_t, std::vector<unsigned char> > finished;
+	std::vector<unsigned char> records;
+	std::vector<std::thread> workers;
+	std::mutex lock;
+	std::condition_variable ready, space;
+	bool failed = false;
+	double elapsed;
+	CorpusWriter writer;
+	if (!writer.open(path)) {
+		cerr << writer.error_message << endl;
+		return 1;
+	}
+	if (threads == 0) { threads = std::thread::hardware_concurrency(); }
+	if (threads == 0) { threads = 1; }
+	// limit chunks kept in memory, while waiting to be written
+	window = threads * 4;
+	auto start = std::chrono::steady_clock::now();
+	auto work = [&]() {
+		uint64_t c, i;
+		std::vector<unsigned char> buffer;
+		while ((c = next++) < chunks) {
+			{
+				std::unique_lock<std::mutex> l(lock);
+				space.wait(l, [&]{ return failed || c < written + window; });
+				if (failed) { return; }
+			}
+			buffer.clear();
+			for (i = c * chunk; i < count && i < (c + 1) * chunk; i++) {
+				Maze m(maze_width, maze_height, maze,
+						Random(base ^ (i * 0x9e3779b97f4a7c15ULL))());
+				CorpusWriter::serialize(m, buffer);
+			}
+			{
+				std::lock_guard<std::mutex> l(lock);
+				finished[c].swap(buffer);
+			}
+			ready.notify_one();
+		}
+	};
+	for (unsigned int t = 0; t < threads; t++) {
+		workers.emplace_back(work);
+	}
+	for (c = 0; c < chunks && !failed; c++) {
+		{
+			std::unique_lock<std::mutex> l(lock);
+			ready.wait(l, [&]{ return finished.count(c) > 0; });
+			records.swap(finished[c]);
+			finished.erase(c);
+		}
+		if (!writer.add(records)) {
+			failed = true;
+		}
+		{
+			std::lock_guard<std::mutex> l(lock);
+			written = c + 1;
+		}
+		space.notify_all();
+	}
+	for (std::thread &t : workers) {
+		t.join();
+	}
+	if (failed || !writer.close()) {
+		cerr << writer.error_message << endl;
+		return 1;
+	}
+	elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+			start).count();
+	cout << "Generated " << count << " mazes in " << elapsed << " s ("
+		<< static_cast<uint64_t>(count / elapsed) << " mazes/s)" << endl;
+	return 0;
 }
 
-/** @brief Helper function to keep energy in a certain range
+uint64_t update_values();
+
+/** @brief Publish game state and wake up observers
  *
- * To keep energy from becoming negative or getting too high, it is clipped
- * here.
+ * Headless boards draw every published state right here, so recordings hold
+ * one frame per change, no matter how fast input is.
  *
+ * @notice mtx has to be held, when calling this function.
  */
-void clip_energy() {
-	if (energy > MAX_ENERGY) {
-		energy = MAX_ENERGY;
+void state_changed() {
+	GameState state;
+	state.energy = game->energy();
+	state.time_drain = game->time_drain();
+	state.step_drain = game->step_drain();
+	state.seconds = game->seconds();
+	state.steps = game->steps();
+	state.score = game->score();
+	state.hint = alex.hint(game->state());
+	state.pos = game->state();
+	state.reward = env->reward_position();
+	snapshot.publish(state);
+	if (synchronous) {
+		update_values();
+		board->update();
 	}
-	else if (energy < MIN_ENERGY) {
-		energy = MIN_ENERGY;
+	{
+		// lock, so observers can't miss this notification
+		std::lock_guard<std::mutex> lock(ui_mtx);
 	}
-	test_game_over();
+	changed.notify_all();
+	if (!run) { stopped.notify_all(); }
 }
 
 /** @brief Timer update helper function
  *
  * This function's only purpose is to periodically increase the internal timer.
  * That timer influences energy drain.
+ *
+ * Ticks are scheduled on absolute deadlines, so the timer doesn't drift and
+ * only wakes up once per second, or when the game ends.
  */
 void timer_update() {
-	// small hack to make UI more responsive, while also allowing somewhat time
-	// accuracy
-	unsigned int t = 0;
+	std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+	std::unique_lock<std::mutex> lock(mtx);
 	while (run) {
-		t++;
-		if (t % 1000 == 0) {
-			mtx.lock();
-		   	seconds++;
-			energy -= time_drain;
-			clip_energy();
-			mtx.unlock();
-			if (seconds % DRAIN_INTERVAL == 0) {
-				if (time_drain_counter++ % 5 == 0) { time_drain_increase *= 2; }
-				time_drain += time_drain_increase;
-			}
-	   	}
-		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		next += std::chrono::seconds(1);
+		if (stopped.wait_until(lock, next, []{ return !run; })) { break; }
+		game->tick();
+		replay.tick();
+		if (game->over()) { run = false; }
+		state_changed();
 	}
 }
 
-/** @brief Updater function for board values */
-void update_values() {
-	mtx.lock();
-	board->energy = ceil(static_cast<float>(energy) / (MAX_ENERGY/20));
-	board->time_drain = time_drain;
-	board->step_drain = step_drain;
-	board->seconds = seconds;
-	board->steps = steps;
-	board->score = score;
-	board->px = (pos>>8)&0x00ff;
-	board->py = pos&0x00ff;
-	board->rx = (env->reward_position()>>8)&0x00ff;
-	board->ry = env->reward_position()&0x00ff;
-	mtx.unlock();
+/** @brief Updater function for board values
+ *
+ * @return uint64_t version of game state, that was copied
+ */
+uint64_t update_values() {
+	uint64_t v;
+	GameState state = snapshot.read(&v);
+	board->energy = ceil(static_cast<float>(state.energy) / (MAX_ENERGY/20));
+	board->time_drain = state.time_drain;
+	board->step_drain = state.step_drain;
+	board->seconds = state.seconds;
+	board->steps = state.steps;
+	board->score = state.score;
+	board->px = Environment::decode_x(state.pos);
+	board->py = Environment::decode_y(state.pos);
+	board->rx = Environment::decode_x(state.reward);
+	board->ry = Environment::decode_y(state.reward);
+	board->synth_help = state.hint;
+	return v;
 }
 
-/** @brief Function for the independent running UI update thread */
+/** @brief Function for the independent running UI update thread
+ *
+ * Sleeps until game state changes. Changes during a frame are drawn together
+ * with the next one, so bursts of input cost 60 frames per second at most.
+ * Game state is read from its snapshot, so drawing never blocks input.
+ */
 void ui_update() {
+	uint64_t drawn;
+	std::chrono::steady_clock::time_point frame;
 	while (run) {
-		update_values();
+		frame = std::chrono::steady_clock::now();
+		drawn = update_values();
 		board->update();
-		std::this_thread::sleep_for(std::chrono::duration<double,
-			   	ratio<1, 60>>(1));
+		std::this_thread::sleep_until(frame + std::chrono::microseconds(16667));
+		std::unique_lock<std::mutex> lock(ui_mtx);
+		changed.wait(lock, [&drawn]{ return !run || snapshot.version() != drawn; });
 	}
 	update_values();
 	board->update();
@@ -176,13 +349,20 @@ void ui_update() {
 void game_loop() {
 	char input;
 	unsigned char action = 0;
-	if (env == nullptr) {
-		env = new Maze(38, 9, maze);
-		pos = env->state();
-	}
+	unsigned short score;
+	delete game;
+	delete env;
+	env = pool->take(maze);
+	game = new Game(env);
+	alex.learn(*env);
+	replay.start(env->width(), env->height(), env->method(), env->seed());
 	board->setup(env->width(), env->height(), env->nodes());
+	mtx.lock();
+	state_changed();
+	mtx.unlock();
 	// Game main loop start
-	std::thread ui_thread(ui_update);
+	std::thread ui_thread;
+	if (!synchronous) { ui_thread = std::thread(ui_update); }
 	std::thread timer_thread(timer_update);
 	while (run) {
 		// main event loop
@@ -196,31 +376,26 @@ void game_loop() {
 			default: action = 0; break;
 		}
 		mtx.lock();
-		if (env->valid_actions() & action) {
-			pos = env->act(action);
-			energy -= step_drain;
-			steps++;
-			if (steps % DRAIN_STEPS == 0) {
-				if (step_drain_counter++ % 5 == 0) { step_drain_increase *= 2; }
-				step_drain += step_drain_increase;
-			}
-			if (pos == env->reward_position()) {
-				pos = env->reset(true);
-				score++;
-				energy += ENERGY_UP;
-			}
-			clip_energy();
+		score = game->score();
+		if (run && game->act(action)) {
+			replay.action(action);
+			// power cell was reached and placed somewhere else
+			if (game->score() != score) { alex.learn(*env); }
+			if (game->over()) { run = false; }
+			state_changed();
 		}
+		if (!run) { state_changed(); }
 		mtx.unlock();
 	}
 	while (input != 'q') {
 		input = board->get_input();
 	}
 	// Game main loop end and cleanup
-	ui_thread.join();
+	if (ui_thread.joinable()) { ui_thread.join(); }
 	timer_thread.join();
-	delete env;
-	env = nullptr;
+	if (synchronous) { board->game_over(); }
+	replay.finish(game->score(), game->seconds());
+	if (log_path != nullptr && !replay.save(log_path)) { log_failed = true; }
 }
 
 /** @brief Method to handle setting selection */
@@ -253,6 +428,12 @@ void settings() {
 	}
 }
 
+/** @brief Play a new game */
+void new_game() {
+	run = true;
+	game_loop();
+}
+
 /** @brief Main menu function
  *
  * Handles main menu, starting and other functionality.
@@ -272,14 +453,7 @@ void main_menu() {
 			board->menu(items, pick);
 		}
 		switch(pick) {
-			case 0:
-				// reset everything to standard values
-				run = true; energy = 300;
-			   	time_drain = 1; time_drain_increase = 1; time_drain_counter = 1;
-				step_drain = 1; step_drain_increase = 1; step_drain_counter = 1;
-				seconds = 0; steps = 0; score = 0; pos = 0;
-			   	game_loop();
-			   	break;
+			case 0: new_game(); break;
 			case 1: settings(); break;
 			case 2:
 			   	board->patrons({"arc", "Pupper! ^-^ (Ulvra)", "Jenny Koda"});
@@ -289,19 +463,199 @@ void main_menu() {
 	}
 }
 
+/** @brief Simulate a recorded game again, without any UI
+ *
+ * @param const char* path - Replay file
+ *
+ * @return int exit code, 1 if replay couldn't be read or doesn't match its
+ * recorded result
+ */
+int replay_game(const char *path) {
+	double elapsed;
+	std::chrono::steady_clock::time_point start;
+	Replay r;
+	if (!r.load(path)) {
+		cerr << r.error_message << endl;
+		return 1;
+	}
+	Maze m(r.width(), r.height(), r.method(), r.seed());
+	Game g(&m);
+	start = std::chrono::steady_clock::now();
+	r.play(g);
+	elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+			start).count();
+	cout << "Score " << g.score() << ", " << g.steps() << " steps in "
+		<< g.seconds() << " s" << endl;
+	cout << "Simulated " << r.size() << " actions in " << elapsed << " s";
+	if (elapsed > 0) {
+		cout << " (" << static_cast<uint64_t>(r.size() / elapsed)
+			<< " actions/s)";
+	}
+	cout << endl;
+	if (g.score() != r.score() || g.seconds() != r.seconds()) {
+		cerr << "Replay doesn't match recorded result (score " << r.score()
+			<< " in " << r.seconds() << " s)" << endl;
+		return 1;
+	}
+	return 0;
+}
+
+/** @brief Show a recorded game
+ *
+ * @param const char* path - Replay file
+ * @param double speed - Actions per second
+ *
+ * @return int exit code
+ */
+int watch_game(const char *path, double speed) {
+	uint64_t i, t = 0;
+	unsigned short score;
+	if (!replay.load(path)) {
+		cerr << replay.error_message << endl;
+		return 1;
+	}
+	board = new CursesBoard();
+	if (!board->capable()) {
+		cerr << board->error_message << endl;
+		cleanup();
+		return 1;
+	}
+	board->setup();
+	env = new Maze(replay.width(), replay.height(), replay.method(),
+			replay.seed());
+	game = new Game(env);
+	alex.learn(*env);
+	run = true;
+	board->setup(env->width(), env->height(), env->nodes());
+	const std::vector<uint64_t> &ticks = replay.tick_steps();
+	for (i = 0; i <= replay.size(); i++) {
+		std::lock_guard<std::mutex> lock(mtx);
+		while (t < ticks.size() && (ticks[t] == i || i == replay.size())) {
+			game->tick();
+			t++;
+		}
+		score = game->score();
+		if (i < replay.size() && game->act(replay.action_at(i)) &&
+				game->score() != score) {
+			alex.learn(*env);
+		}
+		if (game->over() || i == replay.size()) { run = false; }
+		state_changed();
+		update_values();
+		board->update();
+		if (!run) { break; }
+		std::this_thread::sleep_for(std::chrono::duration<double>(1 / speed));
+	}
+	board->game_over();
+	board->get_input();
+	cleanup();
+	return 0;
+}
+
 int main(int argc, char *argv[]) {
 	int c;
+	char *end, *out = nullptr, *keys = nullptr, *record = nullptr;
+	char *replay_path = nullptr, *watch_path = nullptr;
+	double speed = 20;
+	uint64_t count = 0;
+	unsigned int threads = 0;
+	const struct option long_options[] = {
+		{"help", no_argument, nullptr, 'h'},
+		{"seed", required_argument, nullptr, 's'},
+		{"generate", required_argument, nullptr, 'g'},
+		{"out", required_argument, nullptr, 'o'},
+		{"algo", required_argument, nullptr, 'a'},
+		{"size", required_argument, nullptr, 'z'},
+		{"threads", required_argument, nullptr, 't'},
+		{"headless", required_argument, nullptr, 'H'},
+		{"record", required_argument, nullptr, 'r'},
+		{"log", required_argument, nullptr, 'L'},
+		{"replay", required_argument, nullptr, 'R'},
+		{"watch", required_argument, nullptr, 'W'},
+		{"speed", required_argument, nullptr, 'S'},
+		{nullptr, 0, nullptr, 0}
+	};
+	maze_width = MAZE_WIDTH;
+	maze_height = MAZE_HEIGHT;
 	// register signals
 	signal(SIGSEGV, cleanup);
 	signal(SIGINT, cleanup);
 	signal(SIGTERM, cleanup);
 	// end of signal registration
 	// check for command line parmeters
-	while ((c = getopt(argc, argv, "hdkp")) != -1) {
+	while ((c = getopt_long(argc, argv, "hdkps:", long_options, nullptr)) != -1) {
 		if (c == 'h') {
 				print_help();
 				exit(0);
 		}
+		else if (c == 's') {
+			seed = strtoull(optarg, &end, 0);
+			if (*end != '\0') {
+				cerr << "Seed must be a number" << endl;
+				exit(1);
+			}
+			seeded = true;
+		}
+		else if (c == 'g') {
+			count = strtoull(optarg, &end, 10);
+			if (*end != '\0' || count == 0) {
+				cerr << "Number of mazes must be a positive number" << endl;
+				exit(1);
+			}
+		}
+		else if (c == 'o') {
+			out = optarg;
+		}
+		else if (c == 'a') {
+			if (optarg[0] == '\0' || optarg[1] != '\0' ||
+					strchr("dkp", optarg[0]) == nullptr) {
+				cerr << "Algorithm must be one of d, k or p" << endl;
+				exit(1);
+			}
+			maze = optarg[0];
+		}
+		else if (c == 'z') {
+			if (sscanf(optarg, "%dx%d", &maze_width, &maze_height) != 2 ||
+					maze_width <= 0 || maze_height <= 0) {
+				cerr << "Size must be given as WIDTHxHEIGHT" << endl;
+				exit(1);
+			}
+			if (static_cast<long long>(maze_width) * maze_height >
+					Maze::MAX_CELLS) {
+				cerr << "Mazes can't have more than " << Maze::MAX_CELLS
+					<< " nodes" << endl;
+				exit(1);
+			}
+		}
+		else if (c == 'H') {
+			keys = optarg;
+		}
+		else if (c == 'r') {
+			record = optarg;
+		}
+		else if (c == 'L') {
+			log_path = optarg;
+		}
+		else if (c == 'R') {
+			replay_path = optarg;
+		}
+		else if (c == 'W') {
+			watch_path = optarg;
+		}
+		else if (c == 'S') {
+			speed = strtod(optarg, &end);
+			if (*end != '\0' || !(speed > 0)) {
+				cerr << "Speed must be a positive number" << endl;
+				exit(1);
+			}
+		}
+		else if (c == 't') {
+			threads = strtoul(optarg, &end, 10);
+			if (*end != '\0') {
+				cerr << "Number of threads must be a number" << endl;
+				exit(1);
+			}
+		}
 		else if (c != '?') {
 			maze = c;
 		}
@@ -312,6 +666,47 @@ int main(int argc, char *argv[]) {
 		}
 	}
 	// end of command line parameter parsing
+	if (count > 0) {
+		if (out == nullptr) {
+			cerr << "--generate needs an output file (--out)" << endl;
+			exit(1);
+		}
+		exit(generate(count, threads, out));
+	}
+	if (replay_path != nullptr) {
+		exit(replay_game(replay_path));
+	}
+	if (watch_path != nullptr) {
+		exit(watch_game(watch_path, speed));
+	}
+	// start generating mazes in the background, while the menu is up
+	pool = new MazePool(maze_width, maze_height,
+			seeded ? seed : Random::entropy());
+	if (keys != nullptr) {
+		// play a single game, without any terminal
+		RecordingBoard *recorder = nullptr;
+		if (record != nullptr) { board = recorder = new RecordingBoard(keys); }
+		else { board = new NullBoard(keys); }
+		synchronous = true;
+		new_game();
+		c = 0;
+		if (recorder != nullptr && !recorder->save(record)) {
+			cerr << recorder->error_message << endl;
+			c = 1;
+		}
+		cout << "Score " << game->score() << ", " << game->steps()
+			<< " steps in " << game->seconds() << " s" << endl;
+		if (log_failed) {
+			cerr << replay.error_message << endl;
+			c = 1;
+		}
+		cleanup();
+		return c;
+	}
+	else if (record != nullptr) {
+		cerr << "--record needs a headless game (--headless)" << endl;
+		exit(1);
+	}
 	if (board == nullptr) {
 		board = new CursesBoard();
 	}
@@ -323,5 +718,9 @@ int main(int argc, char *argv[]) {
 	board->setup();
 	main_menu();
 	cleanup();
+	if (log_failed) {
+		cerr << replay.error_message << endl;
+		return 1;
+	}
 	return 0;
 }
@@ -0,0 +1,162 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+
+#include "replay.hpp"
+
+void Replay::start(int w, int h, char method, uint64_t seed) {
+	header = ReplayHeader();
+	memcpy(header.magic, REPLAY_MAGIC, sizeof(header.magic));
+	header.version = REPLAY_VERSION;
+	header.width = w;
+	header.height = h;
+	header.method = method;
+	header.seed = seed;
+	packed.clear();
+	ticks.clear();
+	count = 0;
+}
+
+void Replay::action(unsigned char action) {
+	unsigned char dir = 0;
+	while (dir < 3 && !(action & (1 << dir))) { dir++; }
+	if ((count & 3) == 0) { packed.push_back(0); }
+	packed.back() |= dir << ((count&3)<<1);
+	count++;
+}
+
+void Replay::play(Game &game) {
+	uint64_t i, t = 0, n = ticks.size();
+	for (i = 0; i < count; i++) {
+		while (t < n && ticks[t] == i) {
+			game.tick();
+			t++;
+		}
+		game.act(action_at(i));
+	}
+	for (; t < n; t++) {
+		game.tick();
+	}
+}
+
+bool Replay::save(const char *path) {
+	std::vector<unsigned char> deltas;
+	uint64_t last = 0, d;
+	bool ok;
+	FILE *file;
+	for (uint64_t at : ticks) {
+		d = at - last;
+		last = at;
+		do {
+			deltas.push_back((d & 0x7f) | (d > 0x7f ? 0x80 : 0));
+			d >>= 7;
+		} while (d > 0);
+	}
+	header.actions = count;
+	header.ticks = ticks.size();
+	file = fopen(path, "wb");
+	if (file == nullptr) {
+		error_message = std::string("Can't open ") + path + ": " +
+			strerror(errno);
+		return false;
+	}
+	// empty vectors may have no data() at all, so leave them out
+	ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+		(packed.empty() || fwrite(packed.data(), 1, packed.size(), file) ==
+			packed.size()) &&
+		(deltas.empty() || fwrite(deltas.data(), 1, deltas.size(), file) ==
+			deltas.size());
+	ok = fclose(file) == 0 && ok;
+	if (!ok) {
+		error_message = std::string("Can't write replay: ") + strerror(errno);
+	}
+	return ok;
+}
+
+bool Replay::load(const char *path) {
+	uint64_t i, at = 0, d, rest;
+	long here, end;
+	int c, shift;
+	FILE *file = fopen(path, "rb");
+	if (file == nullptr) {
+		error_message = std::string("Can't open ") + path + ": " +
+			strerror(errno);
+		return false;
+	}
+	if (fread(&header, sizeof(header), 1, file) != 1 ||
+			memcmp(header.magic, REPLAY_MAGIC, sizeof(header.magic)) != 0 ||
+			header.version != REPLAY_VERSION) {
+		error_message = std::string(path) + " is not a replay";
+		fclose(file);
+		return false;
+	}
+	// Mazes, that can't be generated again, make the replay useless.
+	if (header.width == 0 || header.height == 0 ||
+			static_cast<uint64_t>(header.width) * header.height > INT_MAX ||
+			(header.method != 'd' && header.method != 'k' &&
+				header.method != 'p')) {
+		error_message = std::string("Replay has a bad maze: ") + path;
+		fclose(file);
+		return false;
+	}
+	// Check sizes against the file, before trusting them for allocations.
+	if ((here = ftell(file)) < 0 || fseek(file, 0, SEEK_END) != 0 ||
+			(end = ftell(file)) < 0 || fseek(file, here, SEEK_SET) != 0) {
+		error_message = std::string("Can't read ") + path;
+		fclose(file);
+		return false;
+	}
+	rest = end - here;
+	count = header.actions;
+	if (count / 4 + (count % 4 != 0) > rest) {
+		error_message = std::string("Replay is truncated: ") + path;
+		fclose(file);
+		count = 0;
+		return false;
+	}
+	packed.resize((count + 3) / 4);
+	ticks.clear();
+	if (!packed.empty() &&
+			fread(packed.data(), 1, packed.size(), file) != packed.size()) {
+		error_message = std::string("Replay is truncated: ") + path;
+		fclose(file);
+		return false;
+	}
+	for (i = 0; i < header.ticks; i++) {
+		d = 0;
+		shift = 0;
+		do {
+			if ((c = fgetc(file)) == EOF || shift > 63) {
+				error_message = std::string("Replay is truncated: ") + path;
+				fclose(file);
+				return false;
+			}
+			d |= static_cast<uint64_t>(c & 0x7f) << shift;
+			shift += 7;
+		} while (c & 0x80);
+		at += d;
+		ticks.push_back(at);
+	}
+	fclose(file);
+	return true;
+}
@@ -0,0 +1,48 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synth/alex.hpp"
+
+void Alex::learn(Environment &env) {
+	uint32_t n, cell, d;
+	uint64_t reward = env.reward_position();
+	char open;
+	height = env.height();
+	n = env.width() * height;
+	from_reward.compute(env, Environment::decode_x(reward) * height +
+			Environment::decode_y(reward));
+	toward.assign(n, 0);
+	for (cell = 0; cell < n; cell++) {
+		// The goal and unreachable nodes have no neighbor, that is closer.
+		d = from_reward.distance(cell) - 1;
+		open = env.node(cell);
+		if ((open & 0x01) && from_reward.distance(cell - 1) == d) {
+			toward[cell] = 0x01;
+		}
+		else if ((open & 0x02) && from_reward.distance(cell + height) == d) {
+			toward[cell] = 0x02;
+		}
+		else if ((open & 0x04) && from_reward.distance(cell + 1) == d) {
+			toward[cell] = 0x04;
+		}
+		else if ((open & 0x08) && from_reward.distance(cell - height) == d) {
+			toward[cell] = 0x08;
+		}
+	}
+}
@@ -0,0 +1,378 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstddef>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include <criterion/criterion.h>
+
+#include "environment/maze.hpp"
+#include "environment/corpus.hpp"
+#include "environment/fixed_maze.hpp"
+#include "environment/maze_batch.hpp"
+#include "environment/maze_pool.hpp"
+#include "ring.hpp"
+
+#define CORPUS_FILE "environments.corpus"
+
+Test(corpus, round_trip) {
+	const int sizes[][2] = {{1, 1}, {3, 5}, {38, 9}, {63, 17}, {200, 100}};
+	std::vector<Maze*> mazes;
+	CorpusWriter writer;
+	Corpus corpus;
+	Maze *view;
+	uint64_t i, seed = 1;
+	cr_assert(writer.open(CORPUS_FILE), "%s", writer.error_message.c_str());
+	for (const auto &s : sizes) {
+		for (char method : {'d', 'k', 'p'}) {
+			mazes.push_back(new Maze(s[0], s[1], method, seed++));
+			cr_assert(writer.add(*mazes.back()), "%s",
+					writer.error_message.c_str());
+		}
+	}
+	cr_assert(writer.close(), "%s", writer.error_message.c_str());
+	cr_assert(corpus.open(CORPUS_FILE), "%s", corpus.error_message.c_str());
+	cr_assert_eq(corpus.size(), mazes.size());
+	for (i = 0; i < corpus.size(); i++) {
+		view = corpus.at(i);
+		cr_assert(view != nullptr, "%s", corpus.error_message.c_str());
+		cr_expect_eq(view->width(), mazes[i]->width());
+		cr_expect_eq(view->height(), mazes[i]->height());
+		cr_expect_eq(view->seed(), mazes[i]->seed());
+		cr_expect_eq(view->method(), mazes[i]->method());
+		cr_expect(view->nodes() == mazes[i]->nodes(), "maze %llu differs",
+				static_cast<unsigned long long>(i));
+		cr_expect_eq(view->reward_position(), mazes[i]->reward_position(),
+				"maze %llu has a different reward",
+				static_cast<unsigned long long>(i));
+		delete view;
+	}
+	cr_expect(corpus.at(corpus.size()) == nullptr);
+	corpus.close();
+	for (Maze *maze : mazes) { delete maze; }
+	remove(CORPUS_FILE);
+}
+
+/** @brief Change one byte of a maze record inside a corpus file
+ *
+ * @param uint64_t i - Index of maze
+ * @param uint64_t at - Byte offset inside the record
+ * @param unsigned char set - Bits to set
+ * @param bool replace - Replace the byte instead of setting bits
+ */
+static void corrupt(uint64_t i, uint64_t at, unsigned char set, bool replace) {
+	FILE *f = fopen(CORPUS_FILE, "r+b");
+	CorpusHeader header;
+	uint64_t offset;
+	int c;
+	cr_assert(f != nullptr);
+	cr_assert_eq(fread(&header, sizeof(header), 1, f), 1);
+	cr_assert_eq(fseek(f, header.index + i * 8, SEEK_SET), 0);
+	cr_assert_eq(fread(&offset, 8, 1, f), 1);
+	cr_assert_eq(fseek(f, offset + at, SEEK_SET), 0);
+	c = fgetc(f);
+	cr_assert_eq(fseek(f, offset + at, SEEK_SET), 0);
+	fputc(replace ? set : (c | set), f);
+	fclose(f);
+}
+
+Test(corpus, broken_records) {
+	const uint64_t map = sizeof(CorpusRecord);
+	CorpusWriter writer;
+	Corpus corpus;
+	Maze *view;
+	uint64_t i, cell;
+	cr_assert(writer.open(CORPUS_FILE), "%s", writer.error_message.c_str());
+	for (i = 0; i < 4; i++) {
+		Maze maze(6, 5, 'k', i);
+		cr_assert(writer.add(maze), "%s", writer.error_message.c_str());
+	}
+	cr_assert(writer.close(), "%s", writer.error_message.c_str());
+	// unknown algorithm
+	corrupt(0, offsetof(CorpusRecord, method), 'x', true);
+	// passage to the east, out of the last column (x 5, y 2)
+	cell = 5 * 5 + 2;
+	corrupt(1, map + (cell>>2), 0x01 << ((cell&3)<<1), false);
+	// passage to the south, out of the last row (x 3, y 4)
+	cell = 3 * 5 + 4;
+	corrupt(2, map + (cell>>2), 0x02 << ((cell&3)<<1), false);
+	cr_assert(corpus.open(CORPUS_FILE), "%s", corpus.error_message.c_str());
+	for (i = 0; i < 3; i++) {
+		view = corpus.at(i);
+		cr_expect(view == nullptr, "broken maze %llu was accepted",
+				static_cast<unsigned long long>(i));
+		delete view;
+	}
+	view = corpus.at(3);
+	cr_expect(view != nullptr, "%s", corpus.error_message.c_str());
+	delete view;
+	corpus.close();
+	remove(CORPUS_FILE);
+}
+
+Test(corpus, not_a_corpus) {
+	FILE *f = fopen(CORPUS_FILE, "wb");
+	Corpus corpus;
+	cr_assert(f != nullptr);
+	fputs("definitely not a maze corpus, but long enough to hold a header", f);
+	fclose(f);
+	cr_expect(!corpus.open(CORPUS_FILE));
+	cr_expect(!corpus.error_message.empty());
+	remove(CORPUS_FILE);
+}
+
+/** @brief Play a FixedMaze and a Maze with the same seed side by side */
+template <int W, int H> static void same_as_maze(char method, uint64_t seed) {
+	FixedMaze<W, H> fixed(method, seed);
+	Maze maze(W, H, method, seed);
+	Random rng(seed);
+	unsigned char action;
+	int episode, step;
+	for (episode = 0; episode < 10; episode++) {
+		cr_assert_eq(fixed.reward_position(), maze.reward_position(),
+				"%c %dx%d seed %llu: reward %d differs", method, W, H,
+				static_cast<unsigned long long>(seed), episode);
+		cr_assert_eq(fixed.state(), maze.state());
+		for (step = 0; step < 200; step++) {
+			cr_assert_eq(fixed.valid_actions(), maze.valid_actions(),
+					"%c %dx%d seed %llu: valid actions differ", method, W, H,
+					static_cast<unsigned long long>(seed));
+			action = 1 << rng.below(4);
+			cr_assert_eq(fixed.act(action), maze.act(action));
+			cr_assert_eq(fixed.reward(), maze.state() ==
+					maze.reward_position() ? 100 : 0);
+		}
+		fixed.reset(true);
+		maze.reset(true);
+	}
+}
+
+Test(fixed_maze, same_as_maze) {
+	uint64_t seed;
+	for (seed = 0; seed < 50; seed++) {
+		for (char method : {'d', 'k', 'p'}) {
+			same_as_maze<1, 1>(method, seed);
+			same_as_maze<3, 5>(method, seed);
+			same_as_maze<38, 9>(method, seed);
+			same_as_maze<64, 64>(method, seed);
+		}
+	}
+}
+
+Test(fixed_maze, play) {
+	FixedMaze<16, 16> fixed('k', 7);
+	std::vector<unsigned char> actions(1000);
+	Random rng(7);
+	int total = 0;
+	for (unsigned char &a : actions) { a = 1 << rng.below(4); }
+	for (unsigned char a : actions) {
+		fixed.act(a);
+		total += fixed.reward();
+	}
+	fixed.reset(false);
+	cr_expect_eq(fixed.play(actions.data(), actions.size()), total);
+}
+
+Test(topology, shared) {
+	uint64_t seed;
+	int i;
+	for (seed = 0; seed < 50; seed++) {
+		char method = "dkp"[seed % 3];
+		Maze maze(38, 9, method, seed), copy(maze), other(maze.layout());
+		cr_assert_eq(copy.packed(), maze.packed(), "copy has its own map");
+		cr_assert_eq(other.packed(), maze.packed(), "agent has its own map");
+		cr_assert(copy.layout() == maze.layout());
+		cr_expect_eq(other.seed(), maze.seed());
+		cr_expect_eq(other.method(), maze.method());
+		cr_expect(other.nodes() == maze.nodes());
+		// same reward stream, so same placements from here on
+		for (i = 0; i < 20; i++) {
+			cr_expect_eq(copy.reward_position(), maze.reward_position(),
+					"%c seed %llu: copy reward %d differs", method,
+					static_cast<unsigned long long>(seed), i);
+			cr_expect_eq(other.reward_position(), maze.reward_position(),
+					"%c seed %llu: agent reward %d differs", method,
+					static_cast<unsigned long long>(seed), i);
+			maze.reset(true);
+			copy.reset(true);
+			other.reset(true);
+		}
+	}
+}
+
+Test(topology, outlives_maze) {
+	Maze *maze = new Maze(16, 16, 'k', 3);
+	std::vector<char> nodes = maze->nodes();
+	Maze copy(*maze);
+	delete maze;
+	cr_expect(copy.nodes() == nodes);
+}
+
+Test(topology, snapshot) {
+	Maze maze(63, 17, 'p', 11);
+	Random rng(11);
+	MazeState saved;
+	std::vector<uint64_t> states, rewards;
+	int i, round;
+	for (i = 0; i < 30; i++) { maze.act(1 << rng.below(4)); }
+	saved = maze.snapshot();
+	// record what happens after the snapshot
+	for (i = 0; i < 200; i++) {
+		maze.act(1 << (i % 4));
+		if (i % 50 == 49) { maze.reset(true); }
+		states.push_back(maze.state());
+		rewards.push_back(maze.reward_position());
+	}
+	// branching off and restoring has to give the same future every time
+	for (round = 0; round < 3; round++) {
+		for (i = 0; i < 100; i++) {
+			maze.act(1 << rng.below(4));
+			if (rng.below(10) == 0) { maze.reset(true); }
+		}
+		maze.restore(saved);
+		for (i = 0; i < 200; i++) {
+			maze.act(1 << (i % 4));
+			if (i % 50 == 49) { maze.reset(true); }
+			cr_assert_eq(maze.state(), states[i], "round %d: step %d", round,
+					i);
+			cr_assert_eq(maze.reward_position(), rewards[i],
+					"round %d: reward after step %d", round, i);
+		}
+	}
+}
+
+/** @brief Step a batch and one Maze per batch entry side by side */
+static void same_as_mazes(unsigned int n, int w, int h, char method) {
+	MazeBatch batch(n, w, h, method, w * h);
+	std::vector<Maze*> mazes;
+	std::vector<uint8_t> actions(n), done(n), masks(n);
+	std::vector<uint32_t> states(n);
+	std::vector<float> rewards(n);
+	Random rng(n);
+	unsigned int i;
+	int step;
+	bool hit;
+	for (i = 0; i < n; i++) {
+		mazes.push_back(new Maze(w, h, method, batch.seed(i)));
+	}
+	for (step = 0; step < 2000; step++) {
+		if (step == 1000) {
+			// everyone back to start, with new power cells
+			batch.reset(states.data());
+			for (i = 0; i < n; i++) {
+				mazes[i]->reset(true);
+				cr_assert_eq(states[i], Environment::decode_x(
+							mazes[i]->state()) * h +
+						Environment::decode_y(mazes[i]->state()));
+			}
+		}
+		if (step == 1500) {
+			batch.regenerate(n / 2);
+			delete mazes[n / 2];
+			mazes[n / 2] = new Maze(w, h, method, batch.seed(n / 2));
+		}
+		batch.valid_actions(masks.data());
+		for (i = 0; i < n; i++) {
+			cr_assert_eq(masks[i], mazes[i]->valid_actions(),
+					"%c %dx%d maze %u step %d: valid actions differ", method, w,
+					h, i, step);
+			actions[i] = rng.below(8) == 0 ? 0 : 1 << rng.below(4);
+		}
+		batch.step(actions.data(), states.data(), rewards.data(), done.data());
+		for (i = 0; i < n; i++) {
+			mazes[i]->act(actions[i]);
+			hit = mazes[i]->state() == mazes[i]->reward_position();
+			// batches reset on their own, once the power cell is reached
+			if (hit) { mazes[i]->reset(true); }
+			cr_assert_eq(done[i], hit ? 1 : 0, "%c %dx%d maze %u step %d: "
+					"done differs", method, w, h, i, step);
+			cr_assert_eq(rewards[i], hit ? 100 : 0);
+			cr_assert_eq(states[i], Environment::decode_x(mazes[i]->state()) *
+					h + Environment::decode_y(mazes[i]->state()),
+					"%c %dx%d maze %u step %d: state differs", method, w, h, i,
+					step);
+		}
+	}
+	for (Maze *maze : mazes) { delete maze; }
+}
+
+Test(maze_batch, same_as_mazes) {
+	for (char method : {'d', 'k', 'p'}) {
+		same_as_mazes(64, 3, 3, method);
+		same_as_mazes(64, 5, 7, method);
+		same_as_mazes(16, 16, 16, method);
+	}
+}
+
+Test(ring, capacity) {
+	Ring<int, 4> ring;
+	int i, item;
+	cr_expect(!ring.pop(item));
+	for (i = 0; i < 3; i++) { cr_assert(ring.push(i)); }
+	cr_expect(ring.full());
+	cr_expect(!ring.push(3));
+	for (i = 0; i < 3; i++) {
+		cr_assert(ring.pop(item));
+		cr_expect_eq(item, i);
+	}
+	cr_expect(!ring.pop(item));
+}
+
+Test(ring, ordering) {
+	const uint64_t count = 1000000;
+	Ring<uint64_t, 8> ring;
+	uint64_t expected = 0, item;
+	bool ordered = true;
+	std::thread producer([&ring, count]{
+		uint64_t i;
+		for (i = 0; i < count; i++) {
+			while (!ring.push(i)) { std::this_thread::yield(); }
+		}
+	});
+	while (expected < count) {
+		if (!ring.pop(item)) {
+			std::this_thread::yield();
+			continue;
+		}
+		if (item != expected) { ordered = false; }
+		expected++;
+	}
+	producer.join();
+	cr_expect(ordered, "items came out of order");
+	cr_expect(!ring.pop(item), "ring has items left");
+}
+
+Test(maze_pool, seeded) {
+	MazePool a(16, 8, 5), b(16, 8, 5);
+	Maze *x, *y;
+	int i;
+	for (i = 0; i < 10; i++) {
+		for (char method : {'d', 'k', 'p'}) {
+			x = a.take(method);
+			y = b.take(method);
+			cr_expect_eq(x->method(), method);
+			cr_expect_eq(x->seed(), y->seed());
+			cr_expect(x->nodes() == y->nodes(), "%c maze %d differs", method,
+					i);
+			delete x;
+			delete y;
+		}
+	}
+}
@@ -0,0 +1,208 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <vector>
+#include <criterion/criterion.h>
+
+#include "environment/maze.hpp"
+#include "environment/distance.hpp"
+#include "reference.hpp"
+
+#define SEEDS 1000
+#define SAMPLES 300
+
+static const int sizes[][2] = {
+	{1, 1}, {1, 9}, {9, 1}, {2, 2}, {3, 5}, {38, 9}, {16, 16}, {63, 17}
+};
+
+/** @brief Test if a maze is perfect
+ *
+ * Perfect mazes have passages, that match on both sides and never lead
+ * outside, with every node reachable and no loops (n - 1 passages).
+ *
+ * @return const char* reason why the maze isn't perfect, or nullptr
+ */
+static const char *imperfect(const std::vector<char> &m, int w, int h) {
+	int x, y, i, n = w * h, reached = 1;
+	long passages = 0;
+	std::vector<int> stack = {0};
+	std::vector<char> seen(n, 0);
+	for (x = 0; x < w; x++) {
+		for (y = 0; y < h; y++) {
+			i = x * h + y;
+			if (m[i] & 0xf0) { return "unknown bits set"; }
+			if ((m[i] & 0x01) && (y == 0 || !(m[i-1] & 0x04))) {
+				return "passage up doesn't match";
+			}
+			if ((m[i] & 0x02) && (x == w-1 || !(m[i+h] & 0x08))) {
+				return "passage right doesn't match";
+			}
+			if ((m[i] & 0x04) && (y == h-1 || !(m[i+1] & 0x01))) {
+				return "passage down doesn't match";
+			}
+			if ((m[i] & 0x08) && (x == 0 || !(m[i-h] & 0x02))) {
+				return "passage left doesn't match";
+			}
+			passages += ((m[i] >> 1) & 1) + ((m[i] >> 2) & 1);
+		}
+	}
+	seen[0] = 1;
+	while (!stack.empty()) {
+		i = stack.back();
+		stack.pop_back();
+		const int next[4] = {i - 1, i + h, i + 1, i - h};
+		for (x = 0; x < 4; x++) {
+			if (((m[i] >> x) & 1) && !seen[next[x]]) {
+				seen[next[x]] = 1;
+				reached++;
+				stack.push_back(next[x]);
+			}
+		}
+	}
+	if (reached != n) { return "not connected"; }
+	if (passages != n - 1) { return "has loops"; }
+	return nullptr;
+}
+
+static void properties(char method) {
+	uint64_t seed;
+	const char *reason;
+	for (const auto &s : sizes) {
+		for (seed = 0; seed < SEEDS; seed++) {
+			Maze maze(s[0], s[1], method, seed);
+			reason = imperfect(maze.nodes(), s[0], s[1]);
+			cr_assert(reason == nullptr, "%c %dx%d seed %llu: %s", method, s[0],
+					s[1], static_cast<unsigned long long>(seed), reason);
+		}
+	}
+}
+
+Test(properties, depth_first) { properties('d'); }
+Test(properties, kruskal) { properties('k'); }
+Test(properties, prim) { properties('p'); }
+
+Test(properties, large) {
+	const char *reason;
+	for (char method : {'d', 'k', 'p'}) {
+		Maze maze(512, 512, method, 1);
+		reason = imperfect(maze.nodes(), 512, 512);
+		cr_assert(reason == nullptr, "%c 512x512: %s", method, reason);
+	}
+}
+
+Test(properties, seeded) {
+	for (char method : {'d', 'k', 'p'}) {
+		Maze a(38, 9, method, 42), b(38, 9, method, 42), c(38, 9, method, 43);
+		cr_assert(a.nodes() == b.nodes(), "%c: same seed, different maze",
+				method);
+		cr_assert(a.reward_position() == b.reward_position(),
+				"%c: same seed, different reward", method);
+		cr_expect(a.nodes() != c.nodes(), "%c: different seed, same maze",
+				method);
+	}
+}
+
+/** @brief Distance of a maze's reward from start, by a field of its own */
+static uint32_t reward_distance(Maze &maze, DistanceField &field) {
+	uint64_t r = maze.reward_position();
+	return field.distance(Environment::decode_x(r) * maze.height() +
+			Environment::decode_y(r));
+}
+
+Test(properties, reward_band) {
+	DistanceField field;
+	Random rng(17);
+	uint64_t seed;
+	uint32_t lo, hi, d, max;
+	int i;
+	for (seed = 0; seed < 200; seed++) {
+		char method = "dkp"[seed % 3];
+		const int *s = sizes[seed % (sizeof(sizes) / sizeof(sizes[0]))];
+		Maze maze(s[0], s[1], method, seed);
+		field.compute(maze, (s[0] / 2) * s[1] + s[1] / 2);
+		max = field.max_distance();
+		// default band, anywhere but start
+		for (i = 0; i < 10; i++) {
+			d = reward_distance(maze, field);
+			cr_assert(max == 0 || d >= 1, "%c %dx%d seed %llu: reward on start",
+					method, s[0], s[1], static_cast<unsigned long long>(seed));
+			cr_assert_eq(maze.optimal_steps(), d);
+			maze.reset(true);
+		}
+		for (i = 0; i < 20; i++) {
+			lo = rng.below(max + 1);
+			hi = lo + rng.below(max - lo + 1);
+			maze.reward_band(lo, hi);
+			maze.reset(true);
+			d = reward_distance(maze, field);
+			cr_assert(d >= lo && d <= hi, "%c %dx%d seed %llu: reward at %u, "
+					"outside of band %u to %u", method, s[0], s[1],
+					static_cast<unsigned long long>(seed), d, lo, hi);
+			cr_assert_eq(maze.optimal_steps(), d);
+		}
+		// bands beyond the farthest node move to it
+		maze.reward_band(max + 1, max + 10);
+		maze.reset(true);
+		cr_assert_eq(reward_distance(maze, field), max,
+				"%c %dx%d seed %llu: band beyond farthest node", method, s[0],
+				s[1], static_cast<unsigned long long>(seed));
+		cr_assert_eq(maze.optimal_steps(), max);
+	}
+}
+
+/** @brief Compare mean statistics of Maze and its reference generator
+ *
+ * Both use different random streams, so mazes differ, but their texture
+ * (dead ends, junctions, corridors and path lengths) has to stay the same.
+ */
+static void differential(char method) {
+	const int w = 24, h = 24;
+	uint64_t seed;
+	MazeStats a = {0, 0, 0, 0}, b = {0, 0, 0, 0}, s;
+	for (seed = 0; seed < SAMPLES; seed++) {
+		s = maze_stats(reference_maze(w, h, method, seed), w, h);
+		a.dead_ends += s.dead_ends / SAMPLES;
+		a.junctions += s.junctions / SAMPLES;
+		a.straights += s.straights / SAMPLES;
+		a.distance += s.distance / SAMPLES;
+		Maze maze(w, h, method, seed);
+		s = maze_stats(maze.nodes(), w, h);
+		b.dead_ends += s.dead_ends / SAMPLES;
+		b.junctions += s.junctions / SAMPLES;
+		b.straights += s.straights / SAMPLES;
+		b.distance += s.distance / SAMPLES;
+	}
+	cr_expect(std::fabs(a.dead_ends - b.dead_ends) < 0.01,
+			"%c dead ends: reference %.4f, maze %.4f", method, a.dead_ends,
+			b.dead_ends);
+	cr_expect(std::fabs(a.junctions - b.junctions) < 0.01,
+			"%c junctions: reference %.4f, maze %.4f", method, a.junctions,
+			b.junctions);
+	cr_expect(std::fabs(a.straights - b.straights) < 0.01,
+			"%c straights: reference %.4f, maze %.4f", method, a.straights,
+			b.straights);
+	cr_expect(std::fabs(a.distance - b.distance) < 0.05 * a.distance,
+			"%c distance: reference %.2f, maze %.2f", method, a.distance,
+			b.distance);
+}
+
+Test(differential, depth_first) { differential('d'); }
+Test(differential, kruskal) { differential('k'); }
+Test(differential, prim) { differential('p'); }
@@ -0,0 +1,146 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+#include <criterion/criterion.h>
+
+#include "environment/maze.hpp"
+#include "environment/distance.hpp"
+#include "environment/solver.hpp"
+
+#define SEEDS 20
+#define PAIRS 50
+
+static const int sizes[][2] = {
+	{1, 1}, {1, 9}, {9, 1}, {3, 5}, {38, 9}, {63, 17}, {64, 64}, {130, 70}
+};
+
+/** @brief Put the player of a maze on a node */
+static void place(Maze &maze, uint32_t cell) {
+	MazeState s = maze.snapshot();
+	s.x = cell / maze.height();
+	s.y = cell % maze.height();
+	maze.restore(s);
+}
+
+static void solve(char method) {
+	std::vector<unsigned char> path;
+	DistanceField field;
+	Solver solver;
+	Random rng(method);
+	uint32_t cells, source, target, steps;
+	uint64_t seed;
+	int pair;
+	for (const auto &s : sizes) {
+		cells = s[0] * s[1];
+		for (seed = 0; seed < SEEDS; seed++) {
+			Maze maze(s[0], s[1], method, seed);
+			solver.load(maze);
+			for (pair = 0; pair < PAIRS; pair++) {
+				source = rng.below(cells);
+				target = rng.below(cells);
+				field.compute(maze, source);
+				steps = solver.solve(source, target, &path);
+				cr_assert_eq(steps, field.distance(target),
+						"%c %dx%d seed %llu: %u to %u took %u, not %u steps",
+						method, s[0], s[1],
+						static_cast<unsigned long long>(seed), source, target,
+						steps, field.distance(target));
+				cr_assert_eq(path.size(), steps);
+				// the path has to be walkable, one valid action after another
+				place(maze, source);
+				for (unsigned char a : path) {
+					cr_assert(maze.valid_actions() & a, "%c %dx%d seed %llu: "
+							"path from %u to %u walks into a wall", method,
+							s[0], s[1], static_cast<unsigned long long>(seed),
+							source, target);
+					maze.act(a);
+				}
+				cr_assert_eq(maze.state(), Environment::encode(
+							target / s[1], target % s[1]));
+			}
+		}
+	}
+}
+
+Test(solver, depth_first) { solve('d'); }
+Test(solver, kruskal) { solve('k'); }
+Test(solver, prim) { solve('p'); }
+
+/** @brief Number of open directions in an action bitmask */
+static int open_count(unsigned char open) {
+	int n = 0;
+	for (; open != 0; open &= open - 1) { n++; }
+	return n;
+}
+
+/** @brief Follow a corridor with act(), the way Maze::run() should
+ *
+ * @return uint32_t number of steps taken
+ */
+static uint32_t walk(Maze &maze, unsigned char action) {
+	uint32_t steps = 0;
+	unsigned char open, back;
+	if (!(maze.valid_actions() & action)) { return 0; }
+	while (true) {
+		maze.act(action);
+		steps++;
+		open = maze.valid_actions();
+		if (maze.state() == maze.reward_position()) { break; }
+		// corridor nodes have exactly two open directions
+		if (open_count(open) != 2) { break; }
+		// keep going, but not back where we came from
+		back = (action << 2 | action >> 2) & 0x0f;
+		action = open & ~back;
+	}
+	return steps;
+}
+
+static void runs(char method) {
+	Random rng(method);
+	uint32_t cells, cell, steps;
+	uint64_t seed;
+	unsigned char action;
+	int run;
+	for (const auto &s : sizes) {
+		cells = s[0] * s[1];
+		for (seed = 0; seed < SEEDS; seed++) {
+			Maze maze(s[0], s[1], method, seed), stepped(maze);
+			for (run = 0; run < PAIRS * 4; run++) {
+				cell = rng.below(cells);
+				action = 1 << rng.below(4);
+				place(maze, cell);
+				place(stepped, cell);
+				steps = maze.run(action);
+				cr_assert_eq(steps, walk(stepped, action), "%c %dx%d seed %llu: "
+						"run from %u with action %d took %u steps", method, s[0],
+						s[1], static_cast<unsigned long long>(seed), cell,
+						action, steps);
+				cr_assert_eq(maze.state(), stepped.state(), "%c %dx%d seed "
+						"%llu: run from %u with action %d ended elsewhere",
+						method, s[0], s[1],
+						static_cast<unsigned long long>(seed), cell, action);
+			}
+		}
+	}
+}
+
+Test(runs, depth_first) { runs('d'); }
+Test(runs, kruskal) { runs('k'); }
+Test(runs, prim) { runs('p'); }
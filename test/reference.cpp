@@ -0,0 +1,145 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "random.hpp"
+#include "reference.hpp"
+
+/** @brief Neighbor of x/y in direction dir, false if outside of maze */
+static bool step(int w, int h, int x, int y, int dir, int &nx, int &ny) {
+	nx = x; ny = y;
+	switch (dir) {
+		case 0: ny = y - 1; break;
+		case 1: nx = x + 1; break;
+		case 2: ny = y + 1; break;
+		case 3: nx = x - 1; break;
+	}
+	return ny >= 0 && ny < h && nx >= 0 && nx < w;
+}
+
+static void depth_first(std::vector<char> &map, int w, int h, int cx, int cy,
+		Random &rng) {
+	int nx, ny, r;
+	std::vector<char> dirs = {0, 1, 2, 3};
+	map[cx * h + cy] |= 0x30;
+	rng.shuffle(dirs.begin(), dirs.end());
+	while (!dirs.empty()) {
+		r = dirs.back();
+		dirs.pop_back();
+		if (step(w, h, cx, cy, r, nx, ny) && !(map[nx * h + ny] & 0x30)) {
+			map[cx * h + cy] |= 1<<r;
+			map[nx * h + ny] |= 0x30 | 1<<(r^2);
+			depth_first(map, w, h, nx, ny, rng);
+		}
+	}
+}
+
+static void kruskal(std::vector<char> &map, int w, int h, Random &rng) {
+	int i, u, n = w * h, wx, wy, vx, vy, cell, dir;
+	std::vector<int> cells(n), walls(n*4);
+	for (i = 0; i < n*4; i++) {
+		if (i % 4 == 0) { cells[i / 4] = i / 4; }
+		walls[i] = i;
+	}
+	rng.shuffle(walls.begin(), walls.end());
+	for (i = 0; i < n*4; i++) {
+		wy = (walls[i] / 4) % h;
+		wx = (walls[i] / 4) / h;
+		dir = walls[i] % 4;
+		if (step(w, h, wx, wy, dir, vx, vy) &&
+				cells[wx * h + wy] != cells[vx * h + vy]) {
+			cell = cells[vx * h + vy];
+			map[wx * h + wy] |= 1<<dir;
+			map[vx * h + vy] |= 1<<(dir^2);
+			for (u = 0; u < n; u++) {
+				if (cells[u] == cell) { cells[u] = cells[wx * h + wy]; }
+			}
+		}
+	}
+}
+
+static void prim(std::vector<char> &map, int w, int h, Random &rng) {
+	int i, k, wall, wx = w/2, wy = h/2, vx, vy, dir;
+	std::vector<int> walls;
+	map[wx * h + wy] |= 0x10;
+	for (i = 0; i < 4; i++) {
+		walls.push_back((wx * h + wy) * 4 + i);
+	}
+	do {
+		// The original shuffled all walls and took the last one, which is the
+		// same as taking a random one.
+		k = rng.below(walls.size());
+		wall = walls[k];
+		walls[k] = walls.back();
+		walls.pop_back();
+		wy = (wall / 4) % h;
+		wx = (wall / 4) / h;
+		dir = wall % 4;
+		if (step(w, h, wx, wy, dir, vx, vy) && !(map[vx * h + vy] & 0x10)) {
+			map[wx * h + wy] |= 1<<dir;
+			map[vx * h + vy] |= 0x10 | 1<<(dir^2);
+			for (i = 0; i < 4; i++) {
+				walls.push_back((vx * h + vy) * 4 + i);
+			}
+		}
+	} while (!walls.empty());
+}
+
+std::vector<char> reference_maze(int w, int h, char method, uint64_t seed) {
+	std::vector<char> map(w * h, 0);
+	Random rng(seed);
+	switch (method) {
+		case 'd': depth_first(map, w, h, w/2, h/2, rng); break;
+		case 'k': kruskal(map, w, h, rng); break;
+		case 'p': prim(map, w, h, rng); break;
+	}
+	for (char &c : map) { c &= 0x0f; }
+	return map;
+}
+
+MazeStats maze_stats(const std::vector<char> &nodes, int w, int h) {
+	MazeStats stats = {0, 0, 0, 0};
+	int n = w * h, i, d, x, y, nx, ny, degree;
+	std::vector<int> dist(n, -1), queue;
+	for (i = 0; i < n; i++) {
+		degree = 0;
+		for (d = 0; d < 4; d++) { degree += (nodes[i] >> d) & 1; }
+		if (degree == 1) { stats.dead_ends++; }
+		else if (degree >= 3) { stats.junctions++; }
+		else if (nodes[i] == 0x05 || nodes[i] == 0x0a) { stats.straights++; }
+	}
+	queue.push_back((w/2) * h + h/2);
+	dist[queue[0]] = 0;
+	for (i = 0; i < static_cast<int>(queue.size()); i++) {
+		x = queue[i] / h;
+		y = queue[i] % h;
+		stats.distance += dist[queue[i]];
+		for (d = 0; d < 4; d++) {
+			if ((nodes[queue[i]] & (1<<d)) && step(w, h, x, y, d, nx, ny) &&
+					dist[nx * h + ny] < 0) {
+				dist[nx * h + ny] = dist[queue[i]] + 1;
+				queue.push_back(nx * h + ny);
+			}
+		}
+	}
+	stats.dead_ends /= n;
+	stats.junctions /= n;
+	stats.straights /= n;
+	stats.distance /= n;
+	return stats;
+}
@@ -0,0 +1,64 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <vector>
+
+#ifndef REFERENCE_H
+#define REFERENCE_H
+
+/** @brief Generate a maze the way Amazed 1.0 did
+ *
+ * Straightforward versions of the original generators, kept to compare
+ * optimized ones against. Randomness comes from a seeded Random instead of
+ * rand(), so results are reproducible, but they don't match Maze's for the
+ * same seed.
+ *
+ * @param int w - Width of maze
+ * @param int h - Height of maze
+ * @param char method - Algorithm to use (see Maze)
+ * @param uint64_t seed - Seed for generation
+ *
+ * @return vector<char> action bitmask of every node (see Environment::nodes())
+ */
+std::vector<char> reference_maze(int w, int h, char method, uint64_t seed);
+
+/** @brief Structural statistics of a maze */
+struct MazeStats {
+	/** @brief Share of nodes with one passage */
+	double dead_ends;
+	/** @brief Share of nodes with three or more passages */
+	double junctions;
+	/** @brief Share of nodes with two passages in a straight line */
+	double straights;
+	/** @brief Mean shortest path length from center, per node of maze */
+	double distance;
+};
+
+/** @brief Compute structural statistics of a maze
+ *
+ * @param const vector<char>& nodes - Action bitmask of every node
+ * @param int w - Width of maze
+ * @param int h - Height of maze
+ *
+ * @return MazeStats statistics
+ */
+MazeStats maze_stats(const std::vector<char> &nodes, int w, int h);
+
+#endif // REFERENCE_H
@@ -0,0 +1,256 @@
+/*
+ *  Copyright 2019 Maxine Michalski <maxine@furfind.net>
+ *
+ *  This file is part of Amazed.
+ *
+ *  Amazed is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Amazed is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Amazed.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <criterion/criterion.h>
+
+#include "environment/maze.hpp"
+#include "synth/alex.hpp"
+#include "game.hpp"
+#include "replay.hpp"
+#include "board/recording.hpp"
+
+#define REPLAY_FILE "replays.replay"
+// bytes of an 'F' record, type byte included
+#define FRAME_SIZE 34
+
+/** @brief Play a scripted game, half following Alex and half at random
+ *
+ * @param Maze& maze - Maze of game
+ * @param Game& game - Game to play
+ * @param Replay& replay - Replay to record to
+ * @param uint64_t seed - Seed for the script
+ */
+static void play(Maze &maze, Game &game, Replay &replay, uint64_t seed) {
+	Random rng(seed);
+	Alex alex;
+	unsigned char action;
+	unsigned short score;
+	int i;
+	alex.learn(maze);
+	for (i = 0; i < 20000 && !game.over(); i++) {
+		if (rng.below(20) == 0) {
+			game.tick();
+			replay.tick();
+			continue;
+		}
+		action = rng.below(2) ? alex.action(game.state()) : 1 << rng.below(4);
+		score = game.score();
+		if (game.act(action)) {
+			replay.action(action);
+			if (game.score() != score) { alex.learn(maze); }
+		}
+	}
+	replay.finish(game.score(), game.seconds());
+}
+
+Test(replay, round_trip) {
+	uint64_t seed;
+	int rewarded = 0;
+	for (seed = 0; seed < 30; seed++) {
+		char method = "dkp"[seed % 3];
+		Maze maze(38, 9, method, seed);
+		Game game(&maze);
+		Replay replay, loaded;
+		replay.start(maze.width(), maze.height(), maze.method(), maze.seed());
+		play(maze, game, replay, seed);
+		cr_assert(replay.save(REPLAY_FILE), "%s", replay.error_message.c_str());
+		cr_assert(loaded.load(REPLAY_FILE), "%s", loaded.error_message.c_str());
+		cr_assert_eq(loaded.size(), replay.size());
+		cr_assert(loaded.tick_steps() == replay.tick_steps());
+		Maze again(loaded.width(), loaded.height(), loaded.method(),
+				loaded.seed());
+		Game replayed(&again);
+		loaded.play(replayed);
+		cr_expect_eq(replayed.score(), game.score(), "seed %llu: score",
+				static_cast<unsigned long long>(seed));
+		cr_expect_eq(replayed.steps(), game.steps(), "seed %llu: steps",
+				static_cast<unsigned long long>(seed));
+		cr_expect_eq(replayed.seconds(), game.seconds(), "seed %llu: seconds",
+				static_cast<unsigned long long>(seed));
+		cr_expect_eq(replayed.energy(), game.energy(), "seed %llu: energy",
+				static_cast<unsigned long long>(seed));
+		cr_expect_eq(replayed.state(), game.state());
+		cr_expect_eq(loaded.score(), game.score());
+		cr_expect_eq(loaded.seconds(), game.seconds());
+		if (game.score() > 0) { rewarded++; }
+	}
+	// make sure games went on long enough, to move power cells around
+	cr_expect(rewarded > 0);
+	remove(REPLAY_FILE);
+}
+
+/** @brief Save a short replay and change its header
+ *
+ * @param F patch - Function, that changes the header in place
+ */
+template <typename F> static void save_patched(F patch) {
+	Replay replay;
+	ReplayHeader header;
+	FILE *file;
+	replay.start(38, 9, 'k', 1);
+	replay.action(0x02);
+	cr_assert(replay.save(REPLAY_FILE), "%s", replay.error_message.c_str());
+	file = fopen(REPLAY_FILE, "r+b");
+	cr_assert(file != nullptr);
+	cr_assert_eq(fread(&header, sizeof(header), 1, file), 1);
+	patch(header);
+	cr_assert_eq(fseek(file, 0, SEEK_SET), 0);
+	cr_assert_eq(fwrite(&header, sizeof(header), 1, file), 1);
+	fclose(file);
+}
+
+Test(replay, corrupt_header) {
+	Replay loaded;
+	// claim far more actions than the file holds
+	save_patched([](ReplayHeader &h){ h.actions = 1ULL << 50; });
+	cr_expect(!loaded.load(REPLAY_FILE));
+	cr_expect(!loaded.error_message.empty());
+	cr_expect_eq(loaded.size(), 0);
+	remove(REPLAY_FILE);
+}
+
+Test(replay, bad_maze) {
+	Replay loaded;
+	save_patched([](ReplayHeader &h){ (void)h; });
+	cr_assert(loaded.load(REPLAY_FILE), "%s", loaded.error_message.c_str());
+	save_patched([](ReplayHeader &h){ h.width = 0; });
+	cr_expect(!loaded.load(REPLAY_FILE));
+	cr_expect(!loaded.error_message.empty());
+	save_patched([](ReplayHeader &h){ h.height = 0; });
+	cr_expect(!loaded.load(REPLAY_FILE));
+	// fits into 32 bits each, but not as a number of nodes
+	save_patched([](ReplayHeader &h){ h.width = 65536; h.height = 65536; });
+	cr_expect(!loaded.load(REPLAY_FILE));
+	save_patched([](ReplayHeader &h){ h.width = 46341; h.height = 46341; });
+	cr_expect(!loaded.load(REPLAY_FILE));
+	save_patched([](ReplayHeader &h){ h.method = 'x'; });
+	cr_expect(!loaded.load(REPLAY_FILE));
+	save_patched([](ReplayHeader &h){ h.method = 0; });
+	cr_expect(!loaded.load(REPLAY_FILE));
+	remove(REPLAY_FILE);
+}
+
+Test(replay, empty) {
+	Replay replay, loaded;
+	replay.start(38, 9, 'd', 3);
+	replay.finish(0, 0);
+	cr_assert(replay.save(REPLAY_FILE), "%s", replay.error_message.c_str());
+	cr_assert(loaded.load(REPLAY_FILE), "%s", loaded.error_message.c_str());
+	cr_expect_eq(loaded.size(), 0);
+	cr_expect(loaded.tick_steps().empty());
+	cr_expect_eq(loaded.method(), 'd');
+	remove(REPLAY_FILE);
+}
+
+/** @brief Copy game state to a board and draw it, like headless amazed does
+ *
+ * @param Board& board - Board to draw on
+ * @param Game& game - Game to show
+ * @param Alex& alex - Synth, that gives hints
+ */
+static void show(Board &board, Game &game, Alex &alex) {
+	board.energy = ceil(static_cast<float>(game.energy()) / (MAX_ENERGY/20));
+	board.time_drain = game.time_drain();
+	board.step_drain = game.step_drain();
+	board.seconds = game.seconds();
+	board.steps = game.steps();
+	board.score = game.score();
+	board.px = Environment::decode_x(game.state());
+	board.py = Environment::decode_y(game.state());
+	board.rx = Environment::decode_x(game.environment()->reward_position());
+	board.ry = Environment::decode_y(game.environment()->reward_position());
+	board.synth_help = alex.hint(game.state());
+	board.update();
+}
+
+/** @brief Read a little endian integer of n bytes from a recording */
+static uint32_t get(const std::vector<unsigned char> &r, size_t at,
+		unsigned int n) {
+	uint32_t v = 0;
+	unsigned int i;
+	for (i = 0; i < n; i++) { v |= static_cast<uint32_t>(r[at + i]) << (i*8); }
+	return v;
+}
+
+Test(recording, headless_game) {
+	Maze maze(38, 9, 'k', 7);
+	Game game(&maze);
+	Alex alex;
+	Random rng(7);
+	std::string keys;
+	std::vector<char> nodes = maze.nodes();
+	size_t at, moves = 0;
+	unsigned short score;
+	unsigned char action;
+	char input;
+	int i;
+	// mostly moves, some of them into walls, and a few unknown keys
+	for (i = 0; i < 500; i++) { keys += "urdlx"[rng.below(5)]; }
+	RecordingBoard board(keys);
+	alex.learn(maze);
+	board.setup(maze.width(), maze.height(), nodes);
+	show(board, game, alex);
+	while ((input = board.get_input()) != 'q' && !game.over()) {
+		switch (input) {
+			case 'u': action = 0x01; break;
+			case 'r': action = 0x02; break;
+			case 'd': action = 0x04; break;
+			case 'l': action = 0x08; break;
+			default: action = 0; break;
+		}
+		score = game.score();
+		if (game.act(action)) {
+			if (game.score() != score) { alex.learn(maze); }
+			show(board, game, alex);
+			moves++;
+		}
+	}
+	show(board, game, alex);
+	board.game_over();
+	cr_assert(moves > 0);
+	// one frame at the start, one per move and one at the end
+	cr_expect_eq(board.frames(), moves + 2);
+	const std::vector<unsigned char> &r = board.records();
+	cr_assert_eq(r.size(), 9 + nodes.size() + board.frames() * FRAME_SIZE + 1);
+	cr_expect_eq(r[0], 'M');
+	cr_expect_eq(get(r, 1, 4), 38);
+	cr_expect_eq(get(r, 5, 4), 9);
+	cr_expect(memcmp(r.data() + 9, nodes.data(), nodes.size()) == 0);
+	cr_expect_eq(r.back(), 'G');
+	// last frame, right before game over
+	at = r.size() - 1 - FRAME_SIZE;
+	cr_assert_eq(r[at], 'F');
+	cr_expect_eq(get(r, at + 1, 4), Environment::decode_x(game.state()));
+	cr_expect_eq(get(r, at + 5, 4), Environment::decode_y(game.state()));
+	cr_expect_eq(get(r, at + 9, 4),
+			Environment::decode_x(maze.reward_position()));
+	cr_expect_eq(get(r, at + 13, 4),
+			Environment::decode_y(maze.reward_position()));
+	cr_expect_eq(get(r, at + 17, 4), game.seconds());
+	cr_expect_eq(get(r, at + 21, 4), game.steps());
+	cr_expect_eq(get(r, at + 25, 2), game.score());
+	cr_expect_eq(static_cast<int16_t>(get(r, at + 27, 2)),
+			ceil(static_cast<float>(game.energy()) / (MAX_ENERGY/20)));
+	cr_expect_eq(static_cast<int16_t>(get(r, at + 29, 2)), game.time_drain());
+	cr_expect_eq(static_cast<int16_t>(get(r, at + 31, 2)), game.step_drain());
+	cr_expect_eq(r[at + 33], alex.hint(game.state()));
+}